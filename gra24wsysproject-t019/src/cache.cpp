@@ -1,47 +1,761 @@
-#ifndef CACHE_HPP
-#define CACHE_HPP
-
-#include <systemc.h>
-#include <vector>
-#include <iostream>
-
-// Cache 模块定义
-class Cache : public sc_module {
-public:
-    // Ports
-    sc_in<bool> clk;          // 时钟信号
-    sc_in<bool> read;         // 读操作信号
-    sc_in<bool> write;        // 写操作信号
-    sc_in<uint32_t> address;  // 地址信号
-    sc_in<uint32_t> w_data;   // 写入数据信号
-    sc_out<uint32_t> r_data;  // 读出数据信号
-    sc_out<bool> ready;       // 操作完成信号
-
-    // 连接到主存的信号
-    sc_out<bool> mem_read;    // 读内存信号
-    sc_out<bool> mem_write;   // 写内存信号
-    sc_out<uint32_t> mem_address; // 主存地址信号
-    sc_in<bool> mem_ready;    // 主存完成信号
-    sc_in<uint32_t> mem_r_data;   // 主存返回数据信号
-
-    SC_HAS_PROCESS(Cache);
-
-    Cache(sc_module_name name, uint32_t cache_size, uint32_t line_size);
-
-private:
-    struct CacheLine {
-        bool valid;
-        uint32_t tag;
-        std::vector<uint8_t> data;
-    };
-
-    uint32_t cache_size;
-    uint32_t line_size;
-    std::vector<CacheLine> cache;
-
-    void process_cache();
-    bool search_cache(uint32_t addr, uint32_t& data);
-    void update_cache(uint32_t addr, uint32_t data);
-};
-
-#endif
\ No newline at end of file
+#include "cache.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+static std::vector<uint32_t> mshr_counts(const CacheConfig& config) {
+    std::vector<uint32_t> counts;
+    for (const CacheLevelConfig& cfg : config.levels) {
+        counts.push_back(cfg.mshrs);
+    }
+    return counts;
+}
+
+// 构造函数：按配置建立各级缓存，预先算好各级掩码和查找延迟表
+Cache::Cache(sc_module_name name, const CacheConfig& config) : sc_module(name),
+    config(config), levels(config.levels.size()),
+    mshrs(mshr_counts(config)), store_buffer(config.store_buffer, config.levels[0].line_size), level_hits(levels, 0), level_writebacks(levels, 0)
+{
+    caches.reserve(levels);
+    probe_latencies.assign(levels + 1, 0);
+    fetch_size = 0;
+    uint32_t miss_path = 0;  // 经过前面各级都未命中的延迟
+    for (uint32_t level = 0; level < levels; level++) {
+        const CacheLevelConfig& cfg = config.levels[level];
+        caches.push_back(make_cache_level(cfg, level + 1));
+        line_masks.push_back(cfg.line_size - 1);
+        prefetchers.emplace_back(cfg.prefetch, cfg.prefetch_degree, cfg.line_size);
+        victims.emplace_back(cfg.victim_entries, cfg.line_size);
+        banks.emplace_back(cfg);
+        fetch_size = std::max(fetch_size, cfg.line_size);
+        probe_latencies[level] = miss_path + cfg.latency;
+        miss_path += cfg.miss_latency();
+    }
+    probe_latencies[levels] = miss_path;
+
+    SC_THREAD(process_cache);
+    sensitive << clk.pos();
+}
+
+// 处理缓存逻辑：每个时钟上升沿收取主存返回的数据、完成就绪的缺失、
+// 接收至多一条请求（没有请求访问缓存时排空一项存储缓冲）、向主存发出至多一条请求、返回至多一个响应
+void Cache::process_cache() {
+    while (true) {
+        wait();
+        cycle++;
+        ready.write(false);
+        mem_read.write(false);
+        mem_write.write(false);
+        mem_exclusive.write(false);
+
+        receive_memory();
+        complete_misses();
+
+        port_busy = false;
+        if (skid_valid && request(skid)) {
+            skid_valid = false;
+        }
+        if (read.read() || write.read()) {
+            MissTarget req = {req_id.read(), write.read(), address.read(), w_data.read(), cycle, pc.read(), false};
+            if (skid_valid) {
+                std::cerr << "Cache request dropped while stalled: " << std::hex << req.addr << std::endl;
+            } else if (!request(req)) {
+                skid = req;
+                skid_valid = true;
+            }
+        }
+
+        if (!port_busy && store_buffer.drainable(cycle)) {
+            drain_store_buffer();
+        }
+
+        issue_prefetches();
+        issue_memory();
+        respond();
+
+        mshrs.sample();
+        store_buffer.sample();
+        full.write(skid_valid || mshrs.any_full() || store_buffer.full());
+    }
+}
+
+// 请求方的访问先经过存储缓冲：对齐的写放入缓冲后按 L1 命中的延迟完成，
+// 读的字在缓冲中时直接转发，其余访问进入缓存。缓冲满时写返回 false，下周期重试
+bool Cache::request(const MissTarget& req) {
+    if (store_buffer.enabled()) {
+        bool aligned = (req.addr & 3) == 0;
+        if (aligned && req.write) {
+            if (!store_buffer.store(req.addr, req.data, cycle)) {
+                return false;
+            }
+            complete(req, req.data, req.start + probe_latencies[0]);
+            return true;
+        }
+        uint32_t data = 0;
+        if (aligned && store_buffer.forward(req.addr, data)) {
+            complete(req, data, req.start + probe_latencies[0]);
+            return true;
+        }
+        if (!aligned && store_buffer.has_line(req.addr)) {
+            // 不对齐的访问可能与缓冲中的字部分重叠，等这一行排空
+            return false;
+        }
+    }
+    port_busy = true;
+    return accept(req);
+}
+
+// 排空最早的存储缓冲表项：各字作为不需要响应的写依次进入缓存，占用一个周期。
+// 第一个字缺失时分配 MSHR，其余合并进去；MSHR 不够时剩下的字留到下次
+void Cache::drain_store_buffer() {
+    StoreBuffer::Entry& entry = store_buffer.front();
+    while (entry.mask) {
+        uint32_t word = __builtin_ctzll(entry.mask);
+        MissTarget req = {0, true, entry.line_addr + word * 4, entry.words[word], cycle, 0, true};
+        if (!accept(req)) {
+            return;
+        }
+        entry.mask &= entry.mask - 1;
+    }
+    store_buffer.pop();
+}
+
+// 处理一条请求。命中时按探查过的各级延迟安排响应；缺失时分配 MSHR，
+// 访问已有缺失的缓存行时合并进去。需要的 MSHR 用完时返回 false，下周期重试
+bool Cache::accept(const MissTarget& req) {
+    // MSHR 按 L1 缓存行记录；各级行大小不同时，从下级取回的数据覆盖这一行
+    uint32_t line_addr = req.addr & ~line_masks[0];
+    Miss* pending = mshrs.find(line_addr);
+    if (pending) {
+        if (pending->prefetch && pending->targets.empty()) {
+            // 需求访问赶上了还没完成的预取
+            uint32_t top = pending->top;
+            if (top > 0 && !mshrs.promote(*pending)) {
+                return false;
+            }
+            prefetchers[top].late();
+        }
+        std::cout << "Secondary miss merged for address: " << std::hex << req.addr << std::endl;
+        mshrs.merge(*pending, req);
+        return true;
+    }
+
+    uint32_t hit_level = holder_level(req.addr);
+    // 多核时共享的行（S/O）没有写权限，像所有级别都缺失一样经总线取得独占
+    bool upgrade = req.write && hit_level < levels && shared_lines.count(line_addr);
+    uint32_t source = upgrade ? levels : hit_level;
+    bool allocate = upgrade || (hit_level > 0 && (!req.write || config.write_allocate));
+    if (allocate && !mshrs.can_allocate(0, source)) {
+        return false;
+    }
+    if (hit_level < levels) {
+        // 命中的是该级的牺牲缓存时换回该级
+        swap_in(hit_level, req.addr);
+    }
+    train_prefetchers(req, hit_level);
+
+    uint64_t done = probe(req.addr, req.start, hit_level);
+    uint32_t data = 0;
+    if (hit_level < levels) {
+        std::cout << "Cache hit at level " << hit_level + 1 << std::endl;
+        level_hits[hit_level]++;
+        search_cache(hit_level, req.addr, data);
+    }
+
+    if (!allocate) {
+        // L1 命中，或不分配的写：立即完成
+        if (req.write) {
+            data = req.data;
+            store(req.addr, data);
+        }
+        complete(req, data, done);
+        return true;
+    }
+
+    Miss& miss = mshrs.allocate(line_addr, source, req);
+    miss.exclusive = req.write;
+    if (upgrade) {
+        std::cout << "Upgrading shared line: " << std::hex << line_addr << std::endl;
+        miss.mem_id = send_memory(false, line_addr, fetch_size, 0, nullptr, done, true);
+        upgrades++;
+    } else if (hit_level < levels) {
+        // 下级缓存命中：经过探查延迟后再读出数据填入上面各级
+        miss.done = done;
+        miss.arrived = true;
+    } else {
+        // 所有级别都未命中：探查完各级后从主存突发取回整条缓存行
+        std::cout << "Cache miss! Fetching from memory." << std::endl;
+        miss.mem_id = send_memory(false, req.addr & ~(fetch_size - 1), fetch_size, 0, nullptr, done, req.write);
+    }
+    return true;
+}
+
+// 需求访问到达的每一级（直到命中的那一级）训练该级的预取器，
+// 得到的预取在本周期处理完请求之后发出
+void Cache::train_prefetchers(const MissTarget& req, uint32_t hit_level) {
+    for (uint32_t level = 0; level <= hit_level && level < levels; level++) {
+        if (!prefetchers[level].enabled()) {
+            continue;
+        }
+        prefetch_candidates.clear();
+        prefetchers[level].access(req.addr, req.pc, hit_level == level, prefetch_candidates);
+        for (uint32_t addr : prefetch_candidates) {
+            prefetch_requests.push_back(std::make_pair(level, addr));
+        }
+    }
+}
+
+// 像需求缺失一样为预取分配 MSHR，只填到预取器所在的级别。已在该级或更上级、
+// 已有未完成缺失的行跳过，MSHR 不够（只剩留给需求缺失的一个）时丢弃
+void Cache::issue_prefetches() {
+    for (const std::pair<uint32_t, uint32_t>& request : prefetch_requests) {
+        uint32_t level = request.first;
+        uint32_t addr = request.second;
+        uint32_t line_addr = addr & ~line_masks[0];
+        if (mshrs.find(line_addr)) {
+            continue;
+        }
+        uint32_t source = holder_level(addr);
+        if (source <= level || !mshrs.can_allocate_prefetch(level, source)) {
+            continue;
+        }
+
+        Miss& miss = mshrs.allocate_prefetch(line_addr, level, source);
+        prefetchers[level].issued();
+        uint64_t done = probe(addr, cycle, source);
+        if (source < levels) {
+            miss.done = done;
+            miss.arrived = true;
+        } else {
+            miss.mem_id = send_memory(false, addr & ~(fetch_size - 1), fetch_size, 0, nullptr, done);
+        }
+    }
+    prefetch_requests.clear();
+}
+
+// 收取主存返回的缓存行。写主存的响应直接忽略
+void Cache::receive_memory() {
+    if (!mem_ready.read()) {
+        return;
+    }
+    for (size_t i = 0; i < mshrs.size(); i++) {
+        Miss& miss = mshrs[i];
+        if (!miss.arrived && miss.mem_id == mem_resp_id.read()) {
+            if (miss.refetch) {
+                // 数据在后来的写之前读出，丢弃后重新取
+                miss.refetch = false;
+                miss.mem_id = send_memory(false, miss.line_addr & ~(fetch_size - 1), fetch_size, 0, nullptr, cycle,
+                                          miss.exclusive);
+                return;
+            }
+            miss.line = mem_r_line.read();
+            miss.shared = mem_shared.read();
+            miss.done = cycle;
+            miss.arrived = true;
+            memory_reads++;
+            return;
+        }
+    }
+}
+
+// 数据就绪的缺失：按包含关系填充各级，再按到达顺序完成合并进来的全部访问，释放 MSHR
+void Cache::complete_misses() {
+    for (size_t i = 0; i < mshrs.size(); ) {
+        Miss& miss = mshrs[i];
+        if (!miss.arrived || miss.done > cycle) {
+            i++;
+            continue;
+        }
+
+        // 由下级缓存提供数据时，到这时才读出，期间写回到下级的数据不会丢失。
+        // 该级已把行替换出去时，从仍持有它的下级读，都没有时改从主存取
+        uint32_t source = levels;
+        bool prefetch_fill = miss.prefetch && miss.targets.empty();
+        if (miss.mem_id == 0) {
+            source = holder_level(miss.line_addr);
+            if (source <= miss.top && prefetch_fill) {
+                // 预取的行已经到了目标级
+                mshrs.release(i);
+                continue;
+            }
+            if (source == levels) {
+                miss.arrived = false;
+                miss.mem_id = send_memory(false, miss.line_addr & ~(fetch_size - 1), fetch_size, 0, nullptr, cycle,
+                                          miss.exclusive);
+                i++;
+                continue;
+            }
+            miss.line.size = config.levels[source].line_size;
+            std::memcpy(miss.line.bytes, held_line(source, miss.line_addr), miss.line.size);
+        }
+
+        if (config.inclusion == EXCLUSIVE) {
+            // 只填 L1（预取时只填预取器所在的级别）。下级命中时把缓存行从该级移出，连同脏位一起放入 L1，
+            // L1 替换出的行再放回下级，相当于交换
+            MemLine line = miss.line;
+            bool dirty = false;
+            uint32_t holder = source;
+            if (holder == levels && miss.exclusive) {
+                // 升级为独占时本核可能还在下级持有该行
+                holder = holder_level(miss.line_addr);
+            }
+            if (holder < levels && holder != miss.top) {
+                bool present = false;
+                for_level(holder, [&](auto& cache) { present = cache.invalidate(miss.line_addr, dirty, line.bytes); });
+                if (!present) {
+                    victims[holder].take(miss.line_addr, line.bytes, dirty);
+                }
+                prefetchers[holder].removed(miss.line_addr & ~line_masks[holder]);
+            }
+            fill_line(miss.top, miss.line_addr, line, dirty, prefetch_fill);
+        } else {
+            // 从下往上填充，上一级替换出的脏行可以写回刚填好的下一级。每级用
+            // 下一级填好后的内容填充：下一级原本就有该行时，它的数据可能比取回的新
+            MemLine line = miss.line;
+            for (uint32_t level = source; level-- > miss.top; ) {
+                fill_line(level, miss.line_addr, line, false, prefetch_fill && level == miss.top);
+                if (level > miss.top) {
+                    const uint8_t* bytes = nullptr;
+                    for_level(level, [&](auto& cache) { bytes = cache.peek_line(miss.line_addr); });
+                    line.size = config.levels[level].line_size;
+                    std::memcpy(line.bytes, bytes, line.size);
+                }
+            }
+        }
+        if (miss.mem_id) {
+            // 总线给出的一致性状态：其他核也有副本时为共享，否则独占
+            if (miss.shared) {
+                shared_lines.insert(miss.line_addr);
+            } else {
+                shared_lines.erase(miss.line_addr);
+            }
+        }
+
+        size_t completed = 0;
+        for (const MissTarget& target : miss.targets) {
+            uint32_t data = target.data;
+            if (target.write && shared_lines.count(miss.line_addr)) {
+                break;
+            }
+            if (target.write) {
+                store(target.addr, data);
+            } else {
+                search_cache(0, target.addr, data);
+            }
+            complete(target, data, cycle);
+            completed++;
+        }
+        if (completed < miss.targets.size()) {
+            // 取回的是共享的行，合并进来的写要等升级为独占，剩下的访问留在 MSHR 中
+            miss.targets.erase(miss.targets.begin(), miss.targets.begin() + completed);
+            miss.exclusive = true;
+            miss.arrived = false;
+            miss.mem_id = send_memory(false, miss.line_addr, fetch_size, 0, nullptr, cycle, true);
+            upgrades++;
+            i++;
+            continue;
+        }
+        mshrs.release(i);
+    }
+}
+
+// 向主存发出队首的请求（保持一个周期）。full 为高时等待
+void Cache::issue_memory() {
+    if (mem_queue.empty() || mem_queue.front().issue > cycle || mem_full.read()) {
+        return;
+    }
+
+    const MemOut& out = mem_queue.front();
+    mem_address.write(out.addr);
+    mem_w_data.write(out.data);
+    mem_req_id.write(out.id);
+    mem_burst_len.write(out.burst_len);
+    if (out.write && out.burst_len) {
+        mem_w_line.write(out.line);
+    }
+    mem_read.write(!out.write);
+    mem_write.write(out.write);
+    mem_exclusive.write(out.exclusive);
+    mem_queue.pop_front();
+}
+
+// 返回一个已完成的响应
+void Cache::respond() {
+    if (responses.empty() || responses.top().done > cycle) {
+        return;
+    }
+
+    const Response& resp = responses.top();
+    r_data.write(resp.data);
+    resp_id.write(resp.id);
+    ready.write(true);
+    accesses++;
+    total_latency += cycle - resp.start;
+    responses.pop();
+}
+
+void Cache::complete(const MissTarget& target, uint32_t data, uint64_t done) {
+    if (target.posted) {
+        return;
+    }
+    responses.push({done, response_seq++, target.id, data, target.start});
+}
+
+// 从 L1 开始逐级查找到第 last 级（全部未命中时查完最后一级），返回查完的周期。
+// 未命中的级别查完标签就去下一级，命中的一级读出数据。每级的访问要等该级存储体的端口或
+// 流水线的入口空闲，不受限制时就是 start + probe_latencies[last]
+uint64_t Cache::probe(uint32_t addr, uint64_t start, uint32_t last) {
+    uint64_t time = start;
+    for (uint32_t level = 0; level <= last && level < levels; level++) {
+        const CacheLevelConfig& cfg = config.levels[level];
+        time = banks[level].reserve(addr, time) + (level == last ? cfg.latency : cfg.miss_latency());
+    }
+    return time;
+}
+
+// 找出持有 addr 的最上一级，行在某级的牺牲缓存中也算该级持有，都没有时返回 levels。
+// 只是探查：不移动缓存行，不改变替换状态和统计
+uint32_t Cache::holder_level(uint32_t addr) const {
+    for (uint32_t level = 0; level < levels; level++) {
+        if (held_line(level, addr)) {
+            return level;
+        }
+    }
+    return levels;
+}
+
+// 第 level 级（或它的牺牲缓存）中包含 addr 的缓存行数据，不在时返回 nullptr。不改变替换状态
+const uint8_t* Cache::held_line(uint32_t level, uint32_t addr) const {
+    const uint8_t* bytes = std::visit([&](const auto& cache) { return cache.peek_line(addr); }, caches[level]);
+    bool dirty = false;
+    if (!bytes && victims[level].enabled()) {
+        bytes = victims[level].peek(addr, dirty);
+    }
+    return bytes;
+}
+
+// 需求访问在第 level 级未命中而牺牲缓存命中：把行换回该级，该级替换出的行进入牺牲缓存。
+// 行不在牺牲缓存中时返回 false。预取和缺失完成时的探查不调用它
+bool Cache::swap_in(uint32_t level, uint32_t addr) {
+    MemLine line;
+    bool dirty = false;
+    if (!victims[level].enabled() || !victims[level].take(addr, line.bytes, dirty)) {
+        return false;
+    }
+    victims[level].absorbed();
+    line.size = config.levels[level].line_size;
+    fill_line(level, addr & ~line_masks[level], line, dirty);
+    return true;
+}
+
+// 从 L1 开始写入一个字：写回级别命中后置脏位并停止，写直达级别继续写下一级，
+// 未命中的级别直接跳过（不分配）。返回写入停止的级别，到达主存时返回 levels
+uint32_t Cache::store(uint32_t addr, uint32_t data) {
+    for (uint8_t level = 0; level < levels; level++) {
+        if (level > 0) {
+            // L1 的访问已在查找时计入
+            banks[level].reserve(addr, cycle);
+        }
+        if (write_word(level, addr, data) && config.levels[level].write_policy == WRITE_BACK) {
+            return level;
+        }
+    }
+
+    // 写主存不等待完成（posted write），主存按到达顺序处理，之后的读能看到新值
+    send_memory(true, addr, 0, data, nullptr, cycle);
+    memory_writes++;
+    return levels;
+}
+
+// 把替换出的脏行写回 level 级：规则与 store 相同，都不持有该行时整行写回主存。
+// 写回经写回缓冲在后台完成，不计入访问延迟
+void Cache::write_back(uint32_t level, uint32_t addr, const MemLine& line) {
+    for (; level < levels; level++) {
+        banks[level].reserve(addr, cycle);
+        bool dirty = config.levels[level].write_policy == WRITE_BACK;
+        bool hit = false;
+        for_level(level, [&](auto& cache) { hit = cache.write_line(addr, line.bytes, line.size, dirty); });
+        if (!hit && victims[level].enabled()) {
+            hit = victims[level].write_line(addr, line.bytes, line.size, dirty);
+        }
+        if (hit && dirty) {
+            return;
+        }
+    }
+
+    send_memory(true, addr, line.size, 0, &line, cycle);
+    memory_writebacks++;
+}
+
+// 查找缓存
+bool Cache::search_cache(uint32_t level, uint32_t addr, uint32_t& data) {
+    bool hit = false;
+    for_level(level, [&](auto& cache) { hit = cache.read_word(addr, data); });
+    return hit;
+}
+
+// 写命中时（包括本级的牺牲缓存）更新缓存行中的一个字，未命中返回 false。写回级别同时置脏位
+bool Cache::write_word(uint32_t level, uint32_t addr, uint32_t data) {
+    bool dirty = config.levels[level].write_policy == WRITE_BACK;
+    bool hit = false;
+    for_level(level, [&](auto& cache) { hit = cache.write_word(addr, data, dirty); });
+    if (!hit && victims[level].enabled()) {
+        hit = victims[level].write_word(addr, data, dirty);
+    }
+    return hit;
+}
+
+// 用下一级（或主存）的缓存行填充本级，dirty 为填入后的脏位。line 覆盖按 line.size
+// 对齐的区域，本级缓存行是其中的一段。prefetch 表示这是本级预取器要的行
+void Cache::fill_line(uint32_t level, uint32_t addr, const MemLine& line, bool dirty, bool prefetch) {
+    uint32_t line_base = addr & ~line_masks[level];
+    uint32_t src_base = addr & ~(line.size - 1);
+    banks[level].reserve(addr, cycle);
+    if (prefetch) {
+        // 已在本级的行不算预取进来的
+        for_level(level, [&](auto& cache) { prefetch = cache.peek_line(addr) == nullptr; });
+    }
+
+    // 行还在本级的牺牲缓存中时取出来用，它比下级的数据新
+    const uint8_t* bytes = line.bytes + (line_base - src_base);
+    MemLine held;
+    bool held_dirty = false;
+    if (victims[level].enabled() && victims[level].take(line_base, held.bytes, held_dirty)) {
+        bytes = held.bytes;
+        dirty = dirty || held_dirty;
+    }
+
+    MemLine victim;
+    uint32_t victim_addr = 0;
+    bool victim_dirty = false;
+    bool evicted = false;
+    for_level(level, [&](auto& cache) {
+        evicted = cache.fill_line(addr, bytes, dirty, victim_addr, victim_dirty, victim.bytes);
+    });
+
+    if (evicted && victims[level].enabled()) {
+        // 替换出的行放入牺牲缓存，从牺牲缓存挤出的行才离开本级
+        MemLine out;
+        uint32_t out_addr = 0;
+        bool out_dirty = false;
+        evicted = victims[level].insert(victim_addr, victim.bytes, victim_dirty, out_addr, out_dirty, out.bytes);
+        victim_addr = out_addr;
+        victim_dirty = out_dirty;
+        victim = out;
+    }
+    if (evicted) {
+        prefetchers[level].removed(victim_addr);
+    }
+    if (prefetch) {
+        prefetchers[level].filled(line_base, evicted, victim_addr);
+    }
+    if (evicted) {
+        victim.size = config.levels[level].line_size;
+        evict(level, victim_addr, victim, victim_dirty);
+    }
+}
+
+// 处理第 level 级替换出的有效缓存行
+void Cache::evict(uint32_t level, uint32_t addr, MemLine& victim, bool dirty) {
+    if (config.inclusion == INCLUSIVE) {
+        // 包含：上面各级（包括它们的牺牲缓存）的副本一并失效（back-invalidation）。上级的脏数据更新，
+        // 从下往上依次合并，L1 的数据最后合并
+        MemLine upper_line;
+        for (uint32_t upper = level; upper-- > 0; ) {
+            for (uint32_t offset = 0; offset < victim.size; offset += config.levels[upper].line_size) {
+                bool present = false;
+                bool upper_dirty = false;
+                for_level(upper, [&](auto& cache) { present = cache.invalidate(addr + offset, upper_dirty, upper_line.bytes); });
+                if (!present && victims[upper].enabled()) {
+                    present = victims[upper].take(addr + offset, upper_line.bytes, upper_dirty);
+                }
+                if (!present) {
+                    continue;
+                }
+                back_invalidations++;
+                prefetchers[upper].removed(addr + offset);
+                if (upper_dirty) {
+                    std::memcpy(victim.bytes + offset, upper_line.bytes, config.levels[upper].line_size);
+                    dirty = true;
+                }
+            }
+        }
+    } else if (config.inclusion == EXCLUSIVE && level + 1 < levels) {
+        // 互斥：替换出的行（无论是否脏）放入下一级
+        fill_line(level + 1, addr, victim, dirty);
+        return;
+    }
+
+    if (dirty) {
+        level_writebacks[level]++;
+        write_back(level + 1, addr, victim);
+    }
+}
+
+// 多核时各级行大小相同，一致性以缓存行为单位。私有各级中最上面的副本最新；
+// 已替换出来、还在发送队列中的写回也算本核的数据，交给总线后不再发出
+SnoopResult Cache::snoop(SnoopKind kind, uint32_t addr, bool keep_dirty, MemLine& line) {
+    uint32_t line_addr = addr & ~line_masks[0];
+    SnoopResult result = {false, false, false, false};
+    line.size = config.levels[0].line_size;
+
+    if (kind != SNOOP_PEEK) {
+        for (auto it = mem_queue.begin(); it != mem_queue.end(); ) {
+            if (it->write && it->burst_len && it->addr == line_addr) {
+                line = it->line;
+                result.supplied = true;
+                result.dirty = true;
+                it = mem_queue.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    bool held = false;
+    bool held_dirty = false;
+    for (uint32_t level = 0; level < levels; level++) {
+        const uint8_t* bytes = nullptr;
+        bool dirty = false;
+        for_level(level, [&](auto& cache) {
+            bytes = cache.peek_line(line_addr);
+            dirty = cache.is_dirty(line_addr);
+        });
+        bool in_victims = false;
+        if (!bytes && victims[level].enabled()) {
+            bytes = victims[level].peek(line_addr, dirty);
+            in_victims = bytes != nullptr;
+        }
+        if (!bytes) {
+            continue;
+        }
+        bool top = !held;
+        if (top) {
+            std::memcpy(line.bytes, bytes, line.size);
+            held = true;
+        }
+        held_dirty = held_dirty || dirty;
+
+        if (kind == SNOOP_INVALIDATE) {
+            MemLine discard;
+            bool discard_dirty = false;
+            if (in_victims) {
+                victims[level].take(line_addr, discard.bytes, discard_dirty);
+            } else {
+                for_level(level, [&](auto& cache) { cache.invalidate(line_addr, discard_dirty, discard.bytes); });
+            }
+            prefetchers[level].removed(line_addr);
+        } else if (kind == SNOOP_SHARE && !keep_dirty) {
+            // 下面几级的副本可能比最上面的旧。变干净后上面的副本会被直接丢弃，先用最新的数据覆盖
+            if (in_victims) {
+                if (!top) {
+                    victims[level].write_line(line_addr, line.bytes, line.size, false);
+                }
+                victims[level].clean(line_addr);
+            } else {
+                for_level(level, [&](auto& cache) {
+                    if (!top) {
+                        cache.write_line(line_addr, line.bytes, line.size, false);
+                    }
+                    cache.clean(line_addr);
+                });
+            }
+        }
+    }
+
+    if (held) {
+        result.supplied = true;
+        result.dirty = result.dirty || held_dirty;
+        result.held = true;
+        result.owner = held_dirty && (kind == SNOOP_PEEK || (kind == SNOOP_SHARE && keep_dirty));
+        if (kind == SNOOP_INVALIDATE) {
+            snoop_invalidations++;
+        } else if (kind == SNOOP_SHARE && shared_lines.insert(line_addr).second) {
+            snoop_downgrades++;
+        }
+    }
+    if (kind == SNOOP_INVALIDATE) {
+        shared_lines.erase(line_addr);
+    }
+    return result;
+}
+
+// 把一条主存请求放入发送队列，返回请求编号。请求按入队顺序发出，
+// 保证同一地址的写回和之后的读按顺序到达主存
+uint32_t Cache::send_memory(bool is_write, uint32_t addr, uint32_t burst_len, uint32_t data,
+                           const MemLine* line, uint64_t issue, bool exclusive) {
+    MemOut out;
+    out.write = is_write;
+    out.addr = addr;
+    out.burst_len = burst_len;
+    out.data = data;
+    if (line) {
+        out.line = *line;
+    }
+    out.id = allocate_id();
+    out.issue = issue;
+    out.exclusive = exclusive;
+    mem_queue.push_back(out);
+
+    // 写排在已发出的取数请求之后，同一区域取回的数据要作废重取
+    if (is_write) {
+        for (size_t i = 0; i < mshrs.size(); i++) {
+            Miss& miss = mshrs[i];
+            if (miss.mem_id && !miss.arrived && (miss.line_addr & ~(fetch_size - 1)) == (addr & ~(fetch_size - 1))) {
+                miss.refetch = true;
+            }
+        }
+    }
+    return out.id;
+}
+
+// 分配主存请求编号。0 表示“没有主存请求”（Miss::mem_id），编号回绕后跳过它
+// 和还在等待主存数据的缺失正在使用的编号
+uint32_t Cache::allocate_id() {
+    while (true) {
+        uint32_t id = next_id++;
+        bool in_use = id == 0;
+        for (size_t i = 0; i < mshrs.size() && !in_use; i++) {
+            in_use = mshrs[i].mem_id == id && !mshrs[i].arrived;
+        }
+        if (!in_use) {
+            return id;
+        }
+    }
+}
+
+void Cache::print_stats(std::ostream& os) const {
+    os << std::dec << "Cache accesses: " << accesses << std::endl;
+    for (uint8_t level = 0; level < levels; level++) {
+        os << "L" << (int)level + 1 << " hits: " << level_hits[level]
+           << ", writebacks: " << level_writebacks[level] << std::endl;
+    }
+    os << "Memory line reads: " << memory_reads << ", line writebacks: " << memory_writebacks
+       << ", word writes: " << memory_writes << std::endl
+       << "Back-invalidations: " << back_invalidations << std::endl
+       << "AMAT: " << (accesses ? (double)total_latency / accesses : 0.0) << " cycles" << std::endl;
+    if (upgrades || snoop_invalidations || snoop_downgrades) {
+        os << "Coherence upgrades: " << upgrades << ", invalidated by snoops: " << snoop_invalidations
+           << ", downgraded by snoops: " << snoop_downgrades << std::endl;
+    }
+    mshrs.print_stats(os);
+    if (store_buffer.enabled()) {
+        store_buffer.print_stats(os);
+    }
+    for (uint32_t level = 0; level < levels; level++) {
+        if (prefetchers[level].enabled()) {
+            prefetchers[level].print_stats(os, level);
+        }
+        if (victims[level].enabled()) {
+            victims[level].print_stats(os, level);
+        }
+        if (banks[level].enabled()) {
+            banks[level].print_stats(os, level, cycle);
+        }
+        if (config.levels[level].huge_pages) {
+            bool huge = std::visit([](const auto& cache) { return cache.on_huge_pages(); }, caches[level]);
+            os << "L" << level + 1 << " line data on " << (huge ? "huge pages" : "regular pages (no huge pages available)")
+               << std::endl;
+        }
+    }
+}
@@ -4,8 +4,42 @@
 #include <systemc.h>
 #include <vector>
 #include <iostream>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <unordered_set>
 
-// Cache 模块定义
+#include "cache_banks.hpp"
+#include "cache_config.hpp"
+#include "cache_level.hpp"
+#include "mem_line.hpp"
+#include "mshr.hpp"
+#include "prefetcher.hpp"
+#include "store_buffer.hpp"
+#include "victim_cache.hpp"
+
+// 一致性总线对私有缓存的监听，见 Cache::snoop
+enum SnoopKind {
+    SNOOP_PEEK,        // 只读出数据：请求方自己升级时，总线确认它仍持有该行
+    SNOOP_SHARE,       // 其他核读：副本降为共享
+    SNOOP_INVALIDATE   // 其他核要写：副本失效
+};
+
+struct SnoopResult {
+    bool supplied;  // 提供了数据：私有缓存中有该行，或替换出来的写回还没发出
+    bool dirty;     // 提供的数据比共享缓存中的新
+    bool held;      // 私有缓存中有该行（不是失效时，监听之后仍持有）
+    bool owner;     // 监听之后仍持有脏的副本（M 或 MOESI 的 O），由本核负责写回
+};
+
+// Cache 模块定义。级数和每级的几何参数、延迟、替换策略、预取器、牺牲缓存在运行时由 CacheConfig 给出。
+// 配置了存储缓冲时，写先进入 L1 前的存储缓冲，在缓存空闲的周期写入缓存。
+// 所有级别都未命中时通过 mem_* 端口从 Memory 突发读取整条缓存行。
+// 非阻塞：缺失记录在 MSHR 中，缺失未完成时继续处理后面的请求。
+// 与 Memory 相同，请求方只需保持 read/write 一个周期，完成时 ready 拉高一个周期，
+// resp_id 标明完成的请求（可能乱序）；full 为高时不要发送新请求。
+// 多核时作为一个核的私有缓存接到 SnoopBus 上：取回的行带有共享标志，共享的行（S/O）
+// 要先经总线升级为独占才能写，其他核的请求经 snoop 降级或失效本核的副本
 class Cache : public sc_module {
 public:
     // Ports
@@ -14,34 +48,134 @@ public:
     sc_in<bool> write;        // 写操作信号
     sc_in<uint32_t> address;  // 地址信号
     sc_in<uint32_t> w_data;   // 写入数据信号
+    sc_in<uint32_t> req_id;   // 请求编号
+    sc_in<uint32_t> pc;       // 访存指令的 PC，只用于按 PC 索引的跨步预取，没有时接 0
     sc_out<uint32_t> r_data;  // 读出数据信号
+    sc_out<uint32_t> resp_id; // 完成的请求编号
     sc_out<bool> ready;       // 操作完成信号
+    sc_out<bool> full;        // MSHR 或存储缓冲已满，请求方暂停发送
 
     // 连接到主存的信号
     sc_out<bool> mem_read;    // 读内存信号
     sc_out<bool> mem_write;   // 写内存信号
     sc_out<uint32_t> mem_address; // 主存地址信号
+    sc_out<uint32_t> mem_w_data;  // 写入主存的数据
+    sc_out<uint32_t> mem_req_id;  // 主存请求编号
     sc_in<bool> mem_ready;    // 主存完成信号
+    sc_in<bool> mem_full;     // 主存控制器队列已满
     sc_in<uint32_t> mem_r_data;   // 主存返回数据信号
+    sc_in<uint32_t> mem_resp_id;  // 主存完成的请求编号
+    sc_out<uint32_t> mem_burst_len; // 突发传输字节数（整条缓存行）
+    sc_out<MemLine> mem_w_line;     // 突发写回主存的缓存行
+    sc_in<MemLine> mem_r_line;      // 主存突发返回的缓存行
+    sc_out<bool> mem_exclusive;     // 取数是为了写（一致性总线上的 GetM），直接接主存时不用
+    sc_in<bool> mem_shared;         // 取回的行在其他核中也有副本，直接接主存时接 false
 
     SC_HAS_PROCESS(Cache);
 
-    Cache(sc_module_name name, uint32_t cache_size, uint32_t line_size);
+    // config 须已通过 CacheConfig::validate 检查
+    Cache(sc_module_name name, const CacheConfig& config = CacheConfig());
+
+    // 打印各级命中次数和平均访问时间（AMAT，单位：时钟周期）
+    void print_stats(std::ostream& os) const;
+
+    // 一致性总线的监听，在时钟下降沿调用（这时本核不在处理请求）。kind 见 SnoopKind；
+    // keep_dirty（MOESI）时降为共享的脏行保持为脏，否则清除脏位，由总线写回共享缓存。
+    // 提供数据时把最新的缓存行复制到 line
+    SnoopResult snoop(SnoopKind kind, uint32_t addr, bool keep_dirty, MemLine& line);
 
 private:
-    struct CacheLine {
-        bool valid;
-        uint32_t tag;
-        std::vector<uint8_t> data;
+    // 缓存数据结构
+    CacheConfig config;                      // 层次结构配置
+    uint32_t levels;                         // 级数
+    std::vector<AnyCacheLevel> caches;       // 多级缓存
+    std::vector<uint32_t> line_masks;        // 每级行内偏移掩码
+    std::vector<uint32_t> probe_latencies;   // 查到第 h 级命中的总延迟（上面各级只查标签），下标 levels 为全部未命中
+    std::vector<Prefetcher> prefetchers;     // 每级一个，未配置的级别不启用
+    std::vector<VictimCache> victims;        // 每级下面的牺牲缓存，未配置的级别不启用
+    std::vector<CacheBanks> banks;           // 每级的存储体和流水线，未配置的级别每周期可以接受一个访问
+
+    // 等待返回给请求方的响应，每周期返回一个
+    struct Response {
+        uint64_t done;
+        uint64_t seq;     // 同一周期完成时按先后顺序返回
+        uint32_t id;
+        uint32_t data;
+        uint64_t start;
+        bool operator>(const Response& other) const {
+            return done != other.done ? done > other.done : seq > other.seq;
+        }
+    };
+
+    // 等待发给主存的请求，按先后顺序每周期发出一个
+    struct MemOut {
+        bool write;
+        uint32_t addr;
+        uint32_t burst_len;  // 0 表示单字访问
+        uint32_t data;
+        MemLine line;
+        uint32_t id;
+        uint64_t issue;      // 最早发出的周期
+        bool exclusive;      // 为写取数据
     };
 
-    uint32_t cache_size;
-    uint32_t line_size;
-    std::vector<CacheLine> cache;
+    uint32_t fetch_size;   // 一次突发取回的字节数：各级中最大的缓存行
+    uint64_t cycle = 0;    // 当前时钟周期
+    uint32_t next_id = 1;  // 下一个主存请求编号，回绕时跳过 0 和仍在等待的编号
+
+    MshrFile mshrs;
+    StoreBuffer store_buffer;
+    bool port_busy = false;    // 本周期已有请求访问缓存，存储缓冲不排空
+    std::priority_queue<Response, std::vector<Response>, std::greater<Response> > responses;
+    uint64_t response_seq = 0;
+    std::deque<MemOut> mem_queue;
+    MissTarget skid;           // 吸收 full 信号一个周期延迟内到达的请求
+    bool skid_valid = false;
+    std::vector<std::pair<uint32_t, uint32_t> > prefetch_requests;  // 本周期要发出的预取（级别, 地址）
+    std::vector<uint32_t> prefetch_candidates;
+    std::unordered_set<uint32_t> shared_lines;  // 与其他核共享的缓存行（S/O），只在持有时有意义
+
+    // 统计
+    uint64_t accesses = 0;
+    uint64_t total_latency = 0;
+    std::vector<uint64_t> level_hits;
+    std::vector<uint64_t> level_writebacks;  // 每级替换出的脏行数
+    uint64_t memory_reads = 0;
+    uint64_t memory_writes = 0;      // 单字写（写直达到主存）
+    uint64_t memory_writebacks = 0;  // 整行写回
+    uint64_t back_invalidations = 0; // 包含模式下因下级替换而失效的上级缓存行
+    uint64_t upgrades = 0;           // 写共享的行，经总线升级为独占
+    uint64_t snoop_invalidations = 0;  // 被其他核的写失效的缓存行
+    uint64_t snoop_downgrades = 0;     // 被其他核的读降为共享的独占行
+
+    // 对第 level 级缓存调用 f。各级的替换策略类型不同，由 std::visit 分派，不经过虚函数
+    template <typename F>
+    void for_level(uint32_t level, F&& f) { std::visit(f, caches[level]); }
 
     void process_cache();
-    bool search_cache(uint32_t addr, uint32_t& data);
-    void update_cache(uint32_t addr, uint32_t data);
+    bool request(const MissTarget& req);
+    void drain_store_buffer();
+    bool accept(const MissTarget& req);
+    void train_prefetchers(const MissTarget& req, uint32_t hit_level);
+    void issue_prefetches();
+    void receive_memory();
+    void complete_misses();
+    void issue_memory();
+    void respond();
+    void complete(const MissTarget& target, uint32_t data, uint64_t done);
+    uint64_t probe(uint32_t addr, uint64_t start, uint32_t last);
+    uint32_t holder_level(uint32_t addr) const;
+    const uint8_t* held_line(uint32_t level, uint32_t addr) const;
+    bool swap_in(uint32_t level, uint32_t addr);
+    uint32_t store(uint32_t addr, uint32_t data);
+    void write_back(uint32_t level, uint32_t addr, const MemLine& line);
+    bool search_cache(uint32_t level, uint32_t addr, uint32_t& data);
+    bool write_word(uint32_t level, uint32_t addr, uint32_t data);
+    void fill_line(uint32_t level, uint32_t addr, const MemLine& line, bool dirty = false, bool prefetch = false);
+    void evict(uint32_t level, uint32_t addr, MemLine& victim, bool dirty);
+    uint32_t send_memory(bool is_write, uint32_t addr, uint32_t burst_len, uint32_t data,
+                         const MemLine* line, uint64_t issue, bool exclusive = false);
+    uint32_t allocate_id();
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,68 @@
+#include "cache_banks.hpp"
+
+#include <algorithm>
+
+#include "cache_geometry.hpp"
+
+CacheBanks::CacheBanks(const CacheLevelConfig& config)
+    : banked(config.banks != 0), ports(banked ? config.bank_ports : 1),
+      busy(std::max(banked ? config.bank_busy : 1u, config.issue_interval())),
+      line_shift(log2_exact(config.line_size)) {
+    uint32_t banks = banked ? config.banks : (busy > 1 ? 1 : 0);
+    port_free.assign(banks * ports, 0);
+    bank_stats.assign(banks, BankStats{0, 0, 0, 0});
+}
+
+uint64_t CacheBanks::reserve(uint32_t addr, uint64_t cycle) {
+    if (!enabled()) {
+        return cycle;
+    }
+    uint32_t bank = (addr >> line_shift) & (bank_stats.size() - 1);
+    uint64_t* free = &port_free[bank * ports];
+    uint32_t port = 0;
+    for (uint32_t i = 1; i < ports; i++) {
+        if (free[i] < free[port]) {
+            port = i;
+        }
+    }
+
+    BankStats& stats = bank_stats[bank];
+    uint64_t start = cycle;
+    if (free[port] > cycle) {
+        start = free[port];
+        stats.conflicts++;
+        stats.stall_cycles += start - cycle;
+        if (start - cycle > max_stall) {
+            max_stall = start - cycle;
+        }
+    }
+    free[port] = start + busy;
+    stats.accesses++;
+    stats.busy_cycles += busy;
+    return start;
+}
+
+void CacheBanks::print_stats(std::ostream& os, uint32_t level, uint64_t cycles) const {
+    uint64_t conflicts = 0;
+    uint64_t stall_cycles = 0;
+    for (const BankStats& stats : bank_stats) {
+        conflicts += stats.conflicts;
+        stall_cycles += stats.stall_cycles;
+    }
+    if (!banked) {
+        const BankStats& stats = bank_stats[0];
+        os << std::dec << "L" << level + 1 << " pipeline (interval " << busy << "): accesses " << stats.accesses
+           << ", utilization " << (cycles ? 100.0 * stats.busy_cycles / cycles : 0.0) << "%, conflicts "
+           << conflicts << ", stall cycles " << stall_cycles << ", max stall " << max_stall << std::endl;
+        return;
+    }
+    os << std::dec << "L" << level + 1 << " banks (" << bank_stats.size() << " x " << ports << " ports, busy " << busy
+       << "): conflicts " << conflicts << ", stall cycles " << stall_cycles << ", max stall " << max_stall
+       << std::endl;
+    for (size_t bank = 0; bank < bank_stats.size(); bank++) {
+        const BankStats& stats = bank_stats[bank];
+        os << "  bank " << bank << ": accesses " << stats.accesses << ", utilization "
+           << (cycles ? 100.0 * stats.busy_cycles / cycles / ports : 0.0) << "%, conflicts " << stats.conflicts
+           << ", stall cycles " << stats.stall_cycles << std::endl;
+    }
+}
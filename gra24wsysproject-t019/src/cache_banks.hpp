@@ -0,0 +1,49 @@
+#ifndef CACHE_BANKS_HPP
+#define CACHE_BANKS_HPP
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "cache_config.hpp"
+
+// 一级缓存的存储体（bank）划分和访问流水线：按缓存行地址交叉分到 banks 个存储体，每个存储体有
+// ports 个端口，每次访问（查找、填充、写回）占用一个端口 busy 个周期。同一存储体的端口都被占用时
+// 访问顺延，顺延的周期加到这次访问的延迟上。端口按预约的先后分配，可以预约将来的周期（逐级探查时
+// 下一级的访问发生在上一级的延迟之后）。
+// 流水线级数少于延迟周期数时，一个访问要占用第一级流水线 issue_interval 个周期，
+// 端口的占用时间取两者中较大的；不划分存储体时整级看作一个存储体、一个端口。
+// 既不划分存储体、又完全流水时不建模，访问不受限制
+class CacheBanks {
+public:
+    static const uint32_t MAX_BANKS = 64;
+
+    CacheBanks(const CacheLevelConfig& config);
+
+    bool enabled() const { return !bank_stats.empty(); }
+
+    // 预约包含 addr 的存储体在 cycle 或之后最早空闲的端口，返回访问开始的周期
+    uint64_t reserve(uint32_t addr, uint64_t cycle);
+
+    // 按存储体打印访问次数、利用率（占用端口的周期 / 经过的周期 / 端口数）和冲突，
+    // 不划分存储体时只打印流水线的一行
+    void print_stats(std::ostream& os, uint32_t level, uint64_t cycles) const;
+
+private:
+    struct BankStats {
+        uint64_t accesses;
+        uint64_t busy_cycles;
+        uint64_t conflicts;     // 因端口被占用而顺延的访问
+        uint64_t stall_cycles;
+    };
+
+    bool banked;
+    uint32_t ports;
+    uint32_t busy;
+    uint32_t line_shift;              // log2(line_size)
+    std::vector<uint64_t> port_free;  // banks * ports，各端口空闲的周期
+    std::vector<BankStats> bank_stats;
+    uint64_t max_stall = 0;
+};
+
+#endif
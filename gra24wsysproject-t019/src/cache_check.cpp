@@ -0,0 +1,185 @@
+#include <systemc.h>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include "cache.hpp"
+#include "memory.hpp"
+
+// 随机读写校验：按配置构造单核 Cache + Memory，背靠背发出随机的读写，
+// 每个读的结果都必须等于按发出顺序写入的最后一个值（没写过的地址为 0）。
+// 地址集中在 rows 个相距 spacing 字节的区域（每个区域 16 个字），大量冲突缺失、替换、
+// 写回和牺牲缓存交换都会发生；另有一半访问是步长 20 字节的顺序流，训练预取器。
+// 用法：cache_check [配置文件 | key=value]...，除缓存配置外还接受
+//   accesses=N（默认 20000）、seed=N（默认 12345）、rows=N（默认 96）、spacing=N（默认 0x200）。
+// 例如 cache_check L1.victim=4 L1.prefetch=stride，或 cache_check rows=6 spacing=0x1000 inclusion=exclusive
+int sc_main(int argc, char** argv) {
+    CacheConfig config;
+    uint32_t accesses = 20000;
+    uint32_t seed = 12345;
+    uint32_t rows = 96;
+    uint32_t spacing = 0x200;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool ok = true;
+        if (arg.compare(0, 9, "accesses=") == 0) {
+            accesses = std::strtoul(arg.c_str() + 9, nullptr, 0);
+        } else if (arg.compare(0, 5, "seed=") == 0) {
+            seed = std::strtoul(arg.c_str() + 5, nullptr, 0);
+            ok = seed != 0;
+        } else if (arg.compare(0, 5, "rows=") == 0) {
+            rows = std::strtoul(arg.c_str() + 5, nullptr, 0);
+            ok = rows != 0;
+        } else if (arg.compare(0, 8, "spacing=") == 0) {
+            spacing = std::strtoul(arg.c_str() + 8, nullptr, 0);
+            ok = spacing >= 64 && spacing % 4 == 0;
+        } else {
+            ok = arg.find('=') != std::string::npos ? config.parse_option(arg) : config.load(arg);
+        }
+        if (!ok) {
+            std::cerr << "Invalid argument: " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (!config.validate()) {
+        return 1;
+    }
+    if (config.cores > 1 || config.vm) {
+        std::cerr << "cache_check drives a single core with physical addresses" << std::endl;
+        return 1;
+    }
+    config.print(std::cout);
+
+    sc_signal<bool> w_signal, r_signal, ready_signal, full_signal;
+    sc_signal<uint32_t> wdata, addr, rdata, req_id, resp_id, pc;
+    sc_clock clk_signal("clk_signal", 10, SC_NS);
+
+    sc_signal<bool> mem_w_signal, mem_r_signal, mem_ready_signal, mem_full_signal;
+    sc_signal<bool> mem_exclusive, mem_shared;
+    sc_signal<uint32_t> mem_wdata, mem_addr, mem_rdata, mem_req_id, mem_resp_id, mem_burst_len;
+    sc_signal<MemLine> mem_wline, mem_rline;
+
+    Cache cache("Cache", config);
+    Memory memory("Memory");
+
+    cache.clk(clk_signal);
+    cache.read(r_signal);
+    cache.write(w_signal);
+    cache.address(addr);
+    cache.w_data(wdata);
+    cache.req_id(req_id);
+    cache.pc(pc);
+    cache.r_data(rdata);
+    cache.resp_id(resp_id);
+    cache.ready(ready_signal);
+    cache.full(full_signal);
+
+    cache.mem_read(mem_r_signal);
+    cache.mem_write(mem_w_signal);
+    cache.mem_exclusive(mem_exclusive);
+    cache.mem_shared(mem_shared);
+    cache.mem_address(mem_addr);
+    cache.mem_w_data(mem_wdata);
+    cache.mem_req_id(mem_req_id);
+    cache.mem_ready(mem_ready_signal);
+    cache.mem_full(mem_full_signal);
+    cache.mem_r_data(mem_rdata);
+    cache.mem_resp_id(mem_resp_id);
+    cache.mem_burst_len(mem_burst_len);
+    cache.mem_w_line(mem_wline);
+    cache.mem_r_line(mem_rline);
+
+    memory.clk(clk_signal);
+    memory.read(mem_r_signal);
+    memory.write(mem_w_signal);
+    memory.address(mem_addr);
+    memory.w_data(mem_wdata);
+    memory.req_id(mem_req_id);
+    memory.burst_len(mem_burst_len);
+    memory.w_line(mem_wline);
+    memory.r_data(mem_rdata);
+    memory.r_line(mem_rline);
+    memory.resp_id(mem_resp_id);
+    memory.ready(mem_ready_signal);
+    memory.full(mem_full_signal);
+
+    // xorshift32，种子固定时结果可重现
+    auto next_random = [&]() {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    };
+
+    std::map<uint32_t, uint32_t> model;     // 地址 -> 按发出顺序最后写入的值
+    std::map<uint32_t, uint32_t> expected;  // 未完成的读：请求编号 -> 应读到的值
+    std::map<uint32_t, uint32_t> read_addr; // 未完成的读：请求编号 -> 地址
+    uint32_t stream = 0;
+    uint32_t sent = 0;
+    uint32_t completed = 0;
+    uint64_t errors = 0;
+    uint64_t cycles = 0;
+
+    // 各模块每次访问打印的过程信息对校验没有意义，运行期间关闭标准输出
+    std::cout.setstate(std::ios::failbit);
+    while (completed < accesses) {
+        r_signal.write(false);
+        w_signal.write(false);
+        if (sent < accesses && !full_signal.read() && next_random() % 3) {
+            uint32_t address = (next_random() % rows) * spacing + (next_random() % 16) * 4;
+            if (next_random() % 2) {
+                stream = (stream + 20) % (rows * spacing);
+                address = stream;
+                pc.write(0x400);
+            } else {
+                pc.write(0x800 + (address & 0x40));
+            }
+            sent++;
+            addr.write(address);
+            req_id.write(sent);
+            if (next_random() % 2) {
+                uint32_t data = next_random();
+                wdata.write(data);
+                w_signal.write(true);
+                model[address] = data;
+            } else {
+                r_signal.write(true);
+                auto it = model.find(address);
+                expected[sent] = it == model.end() ? 0 : it->second;
+                read_addr[sent] = address;
+            }
+        }
+        sc_start(10, SC_NS);
+        cycles++;
+        if (cycles > (uint64_t)accesses * 1000) {
+            std::cout.clear();
+            std::cerr << "Stuck: " << std::dec << accesses - completed << " accesses never completed" << std::endl;
+            return 1;
+        }
+
+        if (!ready_signal.read()) {
+            continue;
+        }
+        completed++;
+        auto it = expected.find(resp_id.read());
+        if (it == expected.end()) {
+            continue;
+        }
+        if (rdata.read() != it->second) {
+            if (++errors <= 5) {
+                std::cerr << "Mismatch: request " << std::dec << it->first << " read 0x" << std::hex
+                          << read_addr[it->first] << ", expected " << it->second << ", got " << rdata.read()
+                          << std::dec << std::endl;
+            }
+        }
+        read_addr.erase(it->first);
+        expected.erase(it);
+    }
+    std::cout.clear();
+
+    cache.print_stats(std::cout);
+    std::cout << std::dec << accesses << " accesses in " << cycles << " cycles, " << errors << " mismatches"
+              << std::endl;
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,469 @@
+#include "cache_config.hpp"
+
+#include <cstdlib>
+#include <fstream>
+
+#include "cache_banks.hpp"
+#include "mem_line.hpp"
+#include "tag_store.hpp"
+#include "tlb.hpp"
+#include "store_buffer.hpp"
+#include "victim_cache.hpp"
+
+static const char* const POLICY_NAMES[] = {"lru", "plru", "srrip", "brrip", "drrip", "fifo", "random"};
+static const char* const INCLUSION_NAMES[] = {"nine", "inclusive", "exclusive"};
+static const char* const PROTOCOL_NAMES[] = {"mesi", "moesi"};
+static const char* const COHERENCE_NAMES[] = {"snoop", "directory"};
+static const char* const PREFETCH_NAMES[] = {"none", "next_line", "stride", "pc_stride", "stream"};
+
+const char* prefetch_name(PrefetchKind kind) {
+    return PREFETCH_NAMES[kind];
+}
+
+static bool is_power_of_two(uint32_t value) {
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+static std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+// 解析非负整数，允许 K / M / G 后缀（1024 / 1024 * 1024 / 1024 * 1024 * 1024）
+static bool parse_number(const std::string& text, uint32_t& value) {
+    char* end = nullptr;
+    unsigned long number = std::strtoul(text.c_str(), &end, 0);
+    if (end == text.c_str()) {
+        return false;
+    }
+    if (*end == 'K' || *end == 'k') {
+        number *= 1024;
+        end++;
+    } else if (*end == 'M' || *end == 'm') {
+        number *= 1024 * 1024;
+        end++;
+    } else if (*end == 'G' || *end == 'g') {
+        number *= 1024ul * 1024 * 1024;
+        end++;
+    }
+    if (*end != '\0' || number > UINT32_MAX) {
+        return false;
+    }
+    value = number;
+    return true;
+}
+
+static bool parse_bool(const std::string& text, bool& value) {
+    if (text == "true" || text == "yes" || text == "1") {
+        value = true;
+    } else if (text == "false" || text == "no" || text == "0") {
+        value = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+CacheConfig::CacheConfig() : levels(2) {
+    levels[1].size = 2048;
+    levels[1].ways = 4;
+    levels[1].latency = 3;
+    levels[1].mshrs = 8;
+    levels[1].policy = REPLACE_DRRIP;
+}
+
+CacheConfig CacheConfig::private_config() const {
+    CacheConfig config = *this;
+    config.levels.pop_back();
+    return config;
+}
+
+bool CacheConfig::set(const std::string& key, const std::string& value) {
+    bool ok = true;
+    if (key == "levels") {
+        uint32_t count = 0;
+        ok = parse_number(value, count) && count > 0;
+        if (ok) {
+            levels.resize(count);
+        }
+    } else if (key == "write_allocate") {
+        ok = parse_bool(value, write_allocate);
+    } else if (key == "inclusion") {
+        ok = false;
+        for (int i = 0; i < 3; i++) {
+            if (value == INCLUSION_NAMES[i]) {
+                inclusion = (InclusionPolicy)i;
+                ok = true;
+            }
+        }
+    } else if (key == "store_buffer") {
+        ok = parse_number(value, store_buffer);
+    } else if (key == "cores") {
+        ok = parse_number(value, cores);
+    } else if (key == "protocol") {
+        ok = false;
+        for (int i = 0; i < 2; i++) {
+            if (value == PROTOCOL_NAMES[i]) {
+                protocol = (CoherenceProtocol)i;
+                ok = true;
+            }
+        }
+    } else if (key == "bus_latency") {
+        ok = parse_number(value, bus_latency);
+    } else if (key == "transfer_latency") {
+        ok = parse_number(value, transfer_latency);
+    } else if (key == "coherence") {
+        ok = false;
+        for (int i = 0; i < 2; i++) {
+            if (value == COHERENCE_NAMES[i]) {
+                coherence = (CoherenceScheme)i;
+                ok = true;
+            }
+        }
+    } else if (key == "directory_entries") {
+        ok = parse_number(value, directory_entries);
+    } else if (key == "directory_ways") {
+        ok = parse_number(value, directory_ways);
+    } else if (key == "hop_latency") {
+        ok = parse_number(value, hop_latency);
+    } else if (key == "vm") {
+        ok = parse_bool(value, vm);
+    } else if (key == "page_size") {
+        ok = parse_number(value, page_size);
+    } else if (key == "walk_cache") {
+        ok = parse_number(value, walk_cache);
+    } else if (key.compare(0, 5, "tlb1.") == 0 || key.compare(0, 5, "tlb2.") == 0) {
+        TlbLevelConfig& cfg = tlbs[key[3] - '1'];
+        std::string param = key.substr(5);
+        if (param == "entries") {
+            ok = parse_number(value, cfg.entries);
+        } else if (param == "ways") {
+            ok = parse_number(value, cfg.ways);
+        } else if (param == "latency") {
+            ok = parse_number(value, cfg.latency);
+        } else {
+            std::cerr << "Unknown TLB parameter: " << key << std::endl;
+            return false;
+        }
+    } else if (key.size() > 3 && key[0] == 'L' && key.find('.') != std::string::npos) {
+        // L<n>.<参数>
+        size_t dot = key.find('.');
+        uint32_t level = 0;
+        if (!parse_number(key.substr(1, dot - 1), level) || level == 0 || level > levels.size()) {
+            std::cerr << "No cache level " << key.substr(0, dot) << " (set levels first)" << std::endl;
+            return false;
+        }
+        CacheLevelConfig& cfg = levels[level - 1];
+        std::string param = key.substr(dot + 1);
+        if (param == "size") {
+            ok = parse_number(value, cfg.size);
+        } else if (param == "line") {
+            ok = parse_number(value, cfg.line_size);
+        } else if (param == "ways") {
+            ok = parse_number(value, cfg.ways);
+        } else if (param == "latency") {
+            ok = parse_number(value, cfg.latency);
+        } else if (param == "mshrs") {
+            ok = parse_number(value, cfg.mshrs);
+        } else if (param == "policy") {
+            ok = false;
+            for (int i = 0; i < 7; i++) {
+                if (value == POLICY_NAMES[i]) {
+                    cfg.policy = (ReplacementPolicy)i;
+                    ok = true;
+                }
+            }
+        } else if (param == "prefetch") {
+            ok = false;
+            for (int i = 0; i < 5; i++) {
+                if (value == PREFETCH_NAMES[i]) {
+                    cfg.prefetch = (PrefetchKind)i;
+                    ok = true;
+                }
+            }
+        } else if (param == "prefetch_degree") {
+            ok = parse_number(value, cfg.prefetch_degree);
+        } else if (param == "victim") {
+            ok = parse_number(value, cfg.victim_entries);
+        } else if (param == "banks") {
+            ok = parse_number(value, cfg.banks);
+        } else if (param == "ports") {
+            ok = parse_number(value, cfg.bank_ports);
+        } else if (param == "bank_busy") {
+            ok = parse_number(value, cfg.bank_busy);
+        } else if (param == "stages") {
+            ok = parse_number(value, cfg.stages);
+        } else if (param == "tag_latency") {
+            ok = parse_number(value, cfg.tag_latency);
+        } else if (param == "huge_pages") {
+            ok = parse_bool(value, cfg.huge_pages);
+        } else if (param == "write") {
+            ok = value == "back" || value == "through";
+            if (ok) {
+                cfg.write_policy = value == "through" ? WRITE_THROUGH : WRITE_BACK;
+            }
+        } else {
+            std::cerr << "Unknown cache parameter: " << key << std::endl;
+            return false;
+        }
+    } else {
+        std::cerr << "Unknown cache option: " << key << std::endl;
+        return false;
+    }
+
+    if (!ok) {
+        std::cerr << "Invalid value for " << key << ": " << value << std::endl;
+    }
+    return ok;
+}
+
+bool CacheConfig::parse_option(const std::string& arg) {
+    size_t eq = arg.find('=');
+    if (eq == std::string::npos) {
+        std::cerr << "Expected key=value: " << arg << std::endl;
+        return false;
+    }
+    return set(trim(arg.substr(0, eq)), trim(arg.substr(eq + 1)));
+}
+
+bool CacheConfig::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Cannot open cache config " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    for (int number = 1; std::getline(file, line); number++) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        if (!parse_option(line)) {
+            std::cerr << "  at " << path << ":" << number << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CacheConfig::validate() const {
+    bool ok = true;
+    for (size_t i = 0; i < levels.size(); i++) {
+        const CacheLevelConfig& cfg = levels[i];
+        std::string name = "L" + std::to_string(i + 1);
+
+        if (!is_power_of_two(cfg.line_size) || cfg.line_size < 4 || cfg.line_size > MemLine::MAX_SIZE) {
+            std::cerr << name << ": line size must be a power of two between 4 and "
+                      << MemLine::MAX_SIZE << std::endl;
+            ok = false;
+            continue;
+        }
+        if (cfg.ways == 0 || cfg.ways > TagStore::MAX_WAYS) {
+            std::cerr << name << ": associativity must be between 1 and " << TagStore::MAX_WAYS << std::endl;
+            ok = false;
+            continue;
+        }
+        if (cfg.size == 0 || cfg.size % (cfg.line_size * cfg.ways) != 0) {
+            std::cerr << name << ": size must be a multiple of line size * ways" << std::endl;
+            ok = false;
+        }
+        if (cfg.latency == 0) {
+            std::cerr << name << ": latency must be at least 1 cycle" << std::endl;
+            ok = false;
+        }
+        if (cfg.mshrs == 0) {
+            std::cerr << name << ": at least one MSHR is required" << std::endl;
+            ok = false;
+        }
+        if (cfg.victim_entries > VictimCache::MAX_ENTRIES) {
+            std::cerr << name << ": victim cache can have at most " << VictimCache::MAX_ENTRIES << " entries" << std::endl;
+            ok = false;
+        }
+        if (cfg.banks && (!is_power_of_two(cfg.banks) || cfg.banks > CacheBanks::MAX_BANKS)) {
+            std::cerr << name << ": banks must be a power of two up to " << CacheBanks::MAX_BANKS << std::endl;
+            ok = false;
+        }
+        if (cfg.banks && (cfg.bank_ports == 0 || cfg.bank_busy == 0)) {
+            std::cerr << name << ": banks need at least one port and a busy time of at least 1 cycle" << std::endl;
+            ok = false;
+        }
+        if (cfg.stages > cfg.latency) {
+            std::cerr << name << ": a pipeline can have at most one stage per latency cycle" << std::endl;
+            ok = false;
+        }
+        if (cfg.tag_latency > cfg.latency) {
+            std::cerr << name << ": tag latency must not exceed the hit latency" << std::endl;
+            ok = false;
+        }
+        if (cfg.prefetch != PREFETCH_NONE && (cfg.prefetch_degree == 0 || cfg.prefetch_degree > 64)) {
+            std::cerr << name << ": prefetch degree must be between 1 and 64" << std::endl;
+            ok = false;
+        }
+
+        // 上级的缓存行必须能整行写回到下级
+        if (i > 0 && cfg.line_size < levels[i - 1].line_size) {
+            std::cerr << name << ": line size must not be smaller than L" << i << std::endl;
+            ok = false;
+        }
+        // 互斥模式在级间整行搬移
+        if (i > 0 && inclusion == EXCLUSIVE && cfg.line_size != levels[0].line_size) {
+            std::cerr << name << ": exclusive hierarchy needs the same line size at every level" << std::endl;
+            ok = false;
+        }
+    }
+    if (store_buffer > StoreBuffer::MAX_ENTRIES) {
+        std::cerr << "Store buffer can have at most " << StoreBuffer::MAX_ENTRIES << " entries" << std::endl;
+        ok = false;
+    }
+    if (vm && !validate_vm()) {
+        ok = false;
+    }
+    if (ok && cores > 1) {
+        ok = validate_multicore();
+    }
+    return ok;
+}
+
+bool CacheConfig::validate_vm() const {
+    bool ok = true;
+    if (page_size != 1u << PAGE_SHIFTS[0] && page_size != 1u << PAGE_SHIFTS[1] && page_size != 1u << PAGE_SHIFTS[2]) {
+        std::cerr << "Page size must be 4K, 2M or 1G" << std::endl;
+        ok = false;
+    }
+    for (int i = 0; i < 2; i++) {
+        const TlbLevelConfig& cfg = tlbs[i];
+        if (i == 0 && cfg.entries == 0) {
+            std::cerr << "L1 TLB needs at least one entry" << std::endl;
+            ok = false;
+        }
+        if (cfg.entries && (cfg.ways == 0 || cfg.ways > Tlb::MAX_WAYS || cfg.entries % cfg.ways != 0 ||
+                            !is_power_of_two(cfg.entries / cfg.ways))) {
+            std::cerr << "TLB" << i + 1 << ": at most " << Tlb::MAX_WAYS << " ways, entries / ways must be a power of two"
+                      << std::endl;
+            ok = false;
+        }
+        if (cfg.entries && cfg.latency == 0) {
+            std::cerr << "TLB" << i + 1 << ": latency must be at least 1 cycle" << std::endl;
+            ok = false;
+        }
+    }
+    if (walk_cache > Tlb::MAX_WAYS) {
+        std::cerr << "Page walk cache can have at most " << Tlb::MAX_WAYS << " entries" << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+// 一致性以共享缓存的行为单位，私有缓存的写都要先取得独占权限，写回只能是整行
+bool CacheConfig::validate_multicore() const {
+    bool ok = true;
+    const CacheLevelConfig& shared = levels.back();
+    if (cores > MAX_CORES) {
+        std::cerr << "At most " << MAX_CORES << " cores are supported" << std::endl;
+        ok = false;
+    }
+    if (levels.size() < 2) {
+        std::cerr << "Multi-core needs at least one private level above the shared one" << std::endl;
+        ok = false;
+    }
+    for (const CacheLevelConfig& cfg : levels) {
+        if (cfg.line_size != shared.line_size) {
+            std::cerr << "Multi-core needs the same line size at every level" << std::endl;
+            ok = false;
+            break;
+        }
+    }
+    if (!write_allocate) {
+        std::cerr << "Multi-core needs write_allocate" << std::endl;
+        ok = false;
+    }
+    if (store_buffer) {
+        // 监听不查存储缓冲，缓冲中的写对其他核不可见
+        std::cerr << "Multi-core does not support a store buffer" << std::endl;
+        ok = false;
+    }
+    if (levels.size() >= 2 && levels[levels.size() - 2].write_policy != WRITE_BACK) {
+        std::cerr << "L" << levels.size() - 1 << ": the last private level must be write-back" << std::endl;
+        ok = false;
+    }
+    if (shared.prefetch != PREFETCH_NONE || shared.victim_entries) {
+        std::cerr << "L" << levels.size() << ": the shared level has no prefetcher or victim cache" << std::endl;
+        ok = false;
+    }
+    if (bus_latency == 0) {
+        std::cerr << "Bus latency must be at least 1 cycle" << std::endl;
+        ok = false;
+    }
+    if (coherence == COHERENCE_DIRECTORY) {
+        if (directory_ways == 0 || directory_entries % directory_ways != 0 ||
+            !is_power_of_two(directory_entries / directory_ways)) {
+            std::cerr << "Directory: entries / ways must be a power of two" << std::endl;
+            ok = false;
+        }
+        if (hop_latency == 0) {
+            std::cerr << "Hop latency must be at least 1 cycle" << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void CacheConfig::print(std::ostream& os) const {
+    for (size_t i = 0; i < levels.size(); i++) {
+        const CacheLevelConfig& cfg = levels[i];
+        os << std::dec << "L" << i + 1 << ": " << cfg.size << " bytes, " << cfg.line_size << "-byte lines, "
+           << cfg.ways << " ways, " << cfg.sets() << " sets, latency " << cfg.latency << ", "
+           << POLICY_NAMES[cfg.policy] << ", write-" << (cfg.write_policy == WRITE_BACK ? "back" : "through")
+           << ", " << cfg.mshrs << " MSHRs";
+        if (cfg.prefetch != PREFETCH_NONE) {
+            os << ", prefetch " << PREFETCH_NAMES[cfg.prefetch] << " x" << cfg.prefetch_degree;
+        }
+        if (cfg.victim_entries) {
+            os << ", " << cfg.victim_entries << "-entry victim cache";
+        }
+        if (cfg.banks) {
+            os << ", " << cfg.banks << " banks x " << cfg.bank_ports << " ports (busy " << cfg.bank_busy << ")";
+        }
+        if (cfg.stages) {
+            os << ", " << cfg.stages << "-stage pipeline (interval " << cfg.issue_interval() << ")";
+        }
+        if (cfg.tag_latency) {
+            os << ", tag latency " << cfg.tag_latency;
+        }
+        if (cfg.huge_pages) {
+            os << ", huge pages";
+        }
+        os << std::endl;
+    }
+    os << "Inclusion: " << INCLUSION_NAMES[inclusion]
+       << ", write-allocate: " << (write_allocate ? "yes" : "no") << std::endl;
+    if (store_buffer) {
+        os << "Store buffer: " << store_buffer << " entries" << std::endl;
+    }
+    if (cores > 1) {
+        os << "Cores: " << cores << ", shared L" << levels.size() << ", " << PROTOCOL_NAMES[protocol]
+           << ", bus latency " << bus_latency << ", cache-to-cache latency " << transfer_latency << std::endl;
+        if (coherence == COHERENCE_DIRECTORY) {
+            os << "Directory: " << directory_entries << " entries, " << directory_ways << " ways, hop latency "
+               << hop_latency << std::endl;
+        }
+    }
+    if (vm) {
+        os << "Virtual memory: " << page_size_name(__builtin_ctz(page_size)) << " pages";
+        for (int i = 0; i < 2; i++) {
+            if (tlbs[i].entries) {
+                os << ", L" << i + 1 << " TLB " << tlbs[i].entries << " entries " << tlbs[i].ways << " ways latency "
+                   << tlbs[i].latency;
+            }
+        }
+        if (walk_cache) {
+            os << ", " << walk_cache << "-entry walk cache";
+        }
+        os << std::endl;
+    }
+}
@@ -0,0 +1,144 @@
+#ifndef CACHE_CONFIG_HPP
+#define CACHE_CONFIG_HPP
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// 替换策略，对应 replacement.hpp 中的各个类
+enum ReplacementPolicy {
+    REPLACE_LRU,
+    REPLACE_TREE_PLRU,
+    REPLACE_SRRIP,
+    REPLACE_BRRIP,
+    REPLACE_DRRIP,
+    REPLACE_FIFO,
+    REPLACE_RANDOM
+};
+
+// 写命中时的策略，每级单独配置
+enum WritePolicy {
+    WRITE_THROUGH,  // 同时写下一级
+    WRITE_BACK      // 只写本级并置脏位，替换出去时写回下一级
+};
+
+// 各级之间的包含关系，整个层次结构统一配置
+enum InclusionPolicy {
+    NON_INCLUSIVE,  // 既不保证包含也不保证互斥（NINE），缺失时填入各级
+    INCLUSIVE,      // 上级的行一定在下级中，下级替换时使上级的副本失效
+    EXCLUSIVE       // 每条行只在一级中：缺失只填 L1，下级作为上级的牺牲缓存，命中时交换
+};
+
+// 多核时私有缓存之间的一致性协议，见 snoop_bus.hpp
+enum CoherenceProtocol {
+    PROTOCOL_MESI,
+    PROTOCOL_MOESI  // 读到别的核修改过的行时，脏数据留在原核（O 状态），不写回共享缓存
+};
+
+// 多核时找到其他核副本的方式
+enum CoherenceScheme {
+    COHERENCE_SNOOP,     // 广播：每个事务监听所有其他核，总线上同一时刻只有一个事务
+    COHERENCE_DIRECTORY  // 稀疏目录记录每行的共享者，只监听它们；不同行的事务可以同时进行
+};
+
+// 硬件预取器种类，见 prefetcher.hpp
+enum PrefetchKind {
+    PREFETCH_NONE,
+    PREFETCH_NEXT_LINE,
+    PREFETCH_STRIDE,
+    PREFETCH_PC_STRIDE,
+    PREFETCH_STREAM
+};
+
+const char* prefetch_name(PrefetchKind kind);
+
+// 一级缓存的配置
+struct CacheLevelConfig {
+    uint32_t size = 1024;        // 容量（字节）
+    uint32_t line_size = 64;     // 缓存行大小（字节）
+    uint32_t ways = 2;           // 相联度
+    uint32_t latency = 1;        // 命中延迟（时钟周期）
+    uint32_t mshrs = 4;          // MSHR 数量
+    ReplacementPolicy policy = REPLACE_LRU;
+    WritePolicy write_policy = WRITE_BACK;
+    PrefetchKind prefetch = PREFETCH_NONE;
+    uint32_t prefetch_degree = 2;  // 每次预取的行数；流缓冲为预取窗口深度
+    uint32_t victim_entries = 0;   // 挂在本级下面的牺牲缓存项数，0 表示没有
+    uint32_t banks = 0;            // 按行地址交叉的存储体数，0 表示不限带宽，见 cache_banks.hpp
+    uint32_t bank_ports = 1;       // 每个存储体的端口数
+    uint32_t bank_busy = 1;        // 每次访问占用端口的周期数
+    uint32_t stages = 0;           // 访问流水线的级数，0 表示每个延迟周期一级（每周期可以进入一个新的访问）
+    uint32_t tag_latency = 0;      // 查标签的周期数，未命中时过了这么多周期就去查下一级；0 表示与 latency 相同
+    bool huge_pages = false;       // 缓存行数据用大页作后备存储（拿不到时退回普通页），见 line_arena.hpp
+
+    uint32_t sets() const { return size / line_size / ways; }
+
+    // 相邻两个访问进入流水线的最小间隔：每级流水线占用 latency / stages 个周期（向上取整）
+    uint32_t issue_interval() const { return stages ? (latency + stages - 1) / stages : 1; }
+
+    // 在本级未命中、转去查下一级之前经过的周期数
+    uint32_t miss_latency() const { return tag_latency ? tag_latency : latency; }
+};
+
+// 一级 TLB 的配置，见 tlb.hpp
+struct TlbLevelConfig {
+    uint32_t entries;  // 项数，0 表示没有这一级
+    uint32_t ways;     // 相联度
+    uint32_t latency;  // 查找延迟（时钟周期）
+};
+
+// 缓存层次结构配置，启动时从配置文件和命令行读入，构造 Cache 前检查一次。
+// 默认两级：L1 1 KiB 2 路 LRU，L2 2 KiB 4 路 DRRIP，行大小都是 64 字节
+struct CacheConfig {
+    static const uint32_t MAX_CORES = 64;
+
+    std::vector<CacheLevelConfig> levels;
+    bool write_allocate = true;  // 写未命中时是否先把缓存行取到 L1
+    InclusionPolicy inclusion = NON_INCLUSIVE;
+    uint32_t store_buffer = 0;   // 请求方与 L1 之间存储缓冲的项数，0 表示写直接进入缓存（只用于单核）
+
+    // 多核（multicore 程序）：最后一级为各核共享，经一致性总线连接，上面各级每核私有一份
+    uint32_t cores = 1;
+    CoherenceProtocol protocol = PROTOCOL_MESI;
+    uint32_t bus_latency = 2;       // 总线仲裁和监听的周期数
+    uint32_t transfer_latency = 4;  // 其他核的私有缓存提供数据（cache-to-cache）的周期数
+    CoherenceScheme coherence = COHERENCE_SNOOP;
+    uint32_t directory_entries = 1024;  // 目录（snoop filter）的项数和相联度
+    uint32_t directory_ways = 8;
+    uint32_t hop_latency = 3;           // 目录模式下核与目录、核与核之间每一跳的周期数
+
+    // 虚拟内存（stufecache）：请求先经过 Mmu 翻译成物理地址，见 mmu.hpp
+    bool vm = false;
+    uint32_t page_size = 4096;               // 映射数据所用的页大小：4K / 2M / 1G
+    TlbLevelConfig tlbs[2] = {{16, 4, 1}, {128, 8, 6}};  // L1 / L2 TLB
+    uint32_t walk_cache = 0;                 // 页表遍历缓存的项数，0 表示没有
+
+    CacheConfig();
+
+    // 每个核私有的部分：去掉最后一级（共享缓存）
+    CacheConfig private_config() const;
+
+    // 设置一项配置。key 为 levels、write_allocate、inclusion、store_buffer、cores、protocol、bus_latency、
+    // transfer_latency、coherence、directory_entries、directory_ways、hop_latency、vm、page_size、walk_cache，
+    // tlb<n>.entries / tlb<n>.ways / tlb<n>.latency（n 为 1 或 2），或 L<n>.<参数>，
+    // 参数为 size / line / ways / latency / mshrs / policy / write / prefetch / prefetch_degree / victim /
+    // banks / ports / bank_busy / stages / tag_latency / huge_pages。
+    // 容量可以带 K / M / G 后缀。失败时打印原因并返回 false
+    bool set(const std::string& key, const std::string& value);
+
+    // 解析一个 key=value 形式的命令行参数
+    bool parse_option(const std::string& arg);
+
+    // 从文件读取配置：每行一项 key = value，# 之后为注释
+    bool load(const std::string& path);
+
+    // 检查各级的几何参数和级间约束，出错时打印原因并返回 false
+    bool validate() const;
+    bool validate_multicore() const;  // cores > 1 时的额外约束
+    bool validate_vm() const;         // vm 时 TLB 和页大小的约束
+
+    void print(std::ostream& os) const;
+};
+
+#endif
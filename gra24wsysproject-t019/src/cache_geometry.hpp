@@ -0,0 +1,126 @@
+#ifndef CACHE_GEOMETRY_HPP
+#define CACHE_GEOMETRY_HPP
+
+#include <cstdint>
+
+#include "cache_config.hpp"
+
+// 缓存几何参数：把地址拆成组号、标签和行内偏移，以及由标签和组号还原缓存行地址。
+// 作为 CacheLevel 的模板参数，统一接口：
+//   Geometry(uint32_t line_size, uint32_t sets, uint32_t ways);
+//   uint32_t offset(uint32_t addr);               // 行内偏移
+//   uint32_t split(uint32_t addr, uint32_t& tag); // 返回组号，标签写入 tag
+//   uint32_t join(uint32_t tag, uint32_t set);    // 缓存行的起始地址
+//   uint32_t line_size(), sets(), ways();
+
+constexpr uint32_t log2_exact(uint32_t value) {
+    return value <= 1 ? 0 : 1 + log2_exact(value >> 1);
+}
+
+// 编译期固定的几何参数：移位和掩码都是常量，组内下标 set * ways + way 也是常量乘法
+template <uint32_t LineSize, uint32_t Sets, uint32_t Ways>
+class FixedGeometry {
+public:
+    static_assert((LineSize & (LineSize - 1)) == 0 && (Sets & (Sets - 1)) == 0,
+                  "fixed geometry needs power-of-two line size and set count");
+
+    FixedGeometry(uint32_t, uint32_t, uint32_t) {}
+
+    static bool matches(const CacheLevelConfig& cfg) {
+        return cfg.line_size == LineSize && cfg.sets() == Sets && cfg.ways == Ways;
+    }
+
+    static constexpr uint32_t offset(uint32_t addr) { return addr & LINE_MASK; }
+
+    static constexpr uint32_t split(uint32_t addr, uint32_t& tag) {
+        tag = addr >> (LINE_SHIFT + SET_SHIFT);
+        return (addr >> LINE_SHIFT) & (Sets - 1);
+    }
+
+    static constexpr uint32_t join(uint32_t tag, uint32_t set) {
+        return ((tag << SET_SHIFT) | set) << LINE_SHIFT;
+    }
+
+    static constexpr uint32_t line_size() { return LineSize; }
+    static constexpr uint32_t sets() { return Sets; }
+    static constexpr uint32_t ways() { return Ways; }
+
+private:
+    static constexpr uint32_t LINE_SHIFT = log2_exact(LineSize);
+    static constexpr uint32_t LINE_MASK = LineSize - 1;
+    static constexpr uint32_t SET_SHIFT = log2_exact(Sets);
+};
+
+// 运行时的几何参数（通用路径）：行大小和组数为 2 的幂，移位和掩码在构造时算好
+class DynamicGeometry {
+public:
+    static bool matches(const CacheLevelConfig& cfg) {
+        uint32_t sets = cfg.sets();
+        return (sets & (sets - 1)) == 0;
+    }
+
+    DynamicGeometry(uint32_t line_size, uint32_t sets, uint32_t ways)
+        : line_bytes(line_size), set_count(sets), way_count(ways),
+          line_shift(log2_exact(line_size)), set_shift(log2_exact(sets)) {}
+
+    uint32_t offset(uint32_t addr) const { return addr & (line_bytes - 1); }
+
+    uint32_t split(uint32_t addr, uint32_t& tag) const {
+        tag = addr >> line_shift >> set_shift;
+        return (addr >> line_shift) & (set_count - 1);
+    }
+
+    uint32_t join(uint32_t tag, uint32_t set) const {
+        return ((tag << set_shift) | set) << line_shift;
+    }
+
+    uint32_t line_size() const { return line_bytes; }
+    uint32_t sets() const { return set_count; }
+    uint32_t ways() const { return way_count; }
+
+private:
+    uint32_t line_bytes;
+    uint32_t set_count;
+    uint32_t way_count;
+    uint32_t line_shift;  // log2(line_size)
+    uint32_t set_shift;   // log2(sets)
+};
+
+// 组数不是 2 的幂时的几何参数（例如 3 MiB 16 路的 3072 组）。组号和标签用
+// 预先算好的乘法逆元代替除法和取模（Lemire 的 fastmod）：
+//   M = floor((2^64 - 1) / sets) + 1
+//   line % sets = ((M * line) mod 2^64) * sets >> 64
+//   line / sets = M * line >> 64
+// 对任意 32 位的 line 和 2 <= sets < 2^32 都是精确的，只需两三次乘法
+class FastmodGeometry {
+public:
+    FastmodGeometry(uint32_t line_size, uint32_t sets, uint32_t ways)
+        : line_bytes(line_size), set_count(sets), way_count(ways),
+          line_shift(log2_exact(line_size)), inverse(UINT64_MAX / sets + 1) {}
+
+    uint32_t offset(uint32_t addr) const { return addr & (line_bytes - 1); }
+
+    uint32_t split(uint32_t addr, uint32_t& tag) const {
+        uint32_t line = addr >> line_shift;
+        tag = (uint32_t)(((unsigned __int128)inverse * line) >> 64);
+        uint64_t low = inverse * line;
+        return (uint32_t)(((unsigned __int128)low * set_count) >> 64);
+    }
+
+    uint32_t join(uint32_t tag, uint32_t set) const {
+        return (tag * set_count + set) << line_shift;
+    }
+
+    uint32_t line_size() const { return line_bytes; }
+    uint32_t sets() const { return set_count; }
+    uint32_t ways() const { return way_count; }
+
+private:
+    uint32_t line_bytes;
+    uint32_t set_count;
+    uint32_t way_count;
+    uint32_t line_shift;  // log2(line_size)
+    uint64_t inverse;     // M
+};
+
+#endif
@@ -0,0 +1,255 @@
+#ifndef CACHE_LEVEL_HPP
+#define CACHE_LEVEL_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <variant>
+
+#include "cache_config.hpp"
+#include "cache_geometry.hpp"
+#include "line_arena.hpp"
+#include "replacement.hpp"
+#include "tag_store.hpp"
+
+// 一级组相联缓存：sets 组，每组 ways 路（最多 TagStore::MAX_WAYS 路）。
+// 标签存放在 SoA 形式的 TagStore 中，缓存行数据存放在连续的 LineArena 中，
+// 替换策略 Policy 和地址拆分方式 Geometry 在编译期选定。常用的几何参数
+// 用 FixedGeometry 实例化，移位和掩码都是常量；其余组数为 2 的幂时用
+// DynamicGeometry，不是 2 的幂时用 FastmodGeometry
+template <class Policy, class Geometry = DynamicGeometry>
+class CacheLevel {
+public:
+    CacheLevel(uint32_t cache_size, uint32_t line_size, uint32_t ways, uint32_t seed = 1,
+               bool huge_pages = false)
+        : geo(line_size, cache_size / line_size / ways, ways),
+          tags(geo.sets(), ways),
+          data(geo.sets() * ways, line_size, huge_pages),
+          policy(geo.sets(), ways, seed) {}
+
+    // 读命中时返回地址处的字（缓存行按小端存放，与 Memory 一致）
+    bool read_word(uint32_t addr, uint32_t& word) {
+        uint32_t set;
+        int way = find_way(addr, set);
+        if (way < 0) {
+            return false;
+        }
+        policy.on_hit(set, way);
+
+        const uint8_t* line = data.line(set * geo.ways() + way);
+        uint32_t offset = geo.offset(addr);
+        word = 0;
+        for (int i = 3; i >= 0; i--) {
+            word = (word << 8) | line[offset + i];
+        }
+        return true;
+    }
+
+    // 写命中时更新缓存行中的一个字，未命中返回 false。
+    // dirty 为 true 时（写回策略）置脏位，替换时需要写回下一级
+    bool write_word(uint32_t addr, uint32_t word, bool dirty = false) {
+        uint32_t set;
+        int way = find_way(addr, set);
+        if (way < 0) {
+            return false;
+        }
+        policy.on_hit(set, way);
+        if (dirty) {
+            tags.mark_dirty(set, way);
+        }
+
+        uint8_t* line = data.line(set * geo.ways() + way);
+        uint32_t offset = geo.offset(addr);
+        for (int i = 0; i < 4; i++) {
+            line[offset + i] = word & 0xFF;
+            word >>= 8;
+        }
+        return true;
+    }
+
+    // 接收上一级写回的数据（size 字节，不超过本级缓存行），未命中返回 false。
+    // 写回不是一次访问，不更新替换状态
+    bool write_line(uint32_t addr, const uint8_t* bytes, uint32_t size, bool dirty) {
+        uint32_t set;
+        int way = find_way(addr, set);
+        if (way < 0) {
+            return false;
+        }
+        if (dirty) {
+            tags.mark_dirty(set, way);
+        }
+        std::memcpy(data.line(set * geo.ways() + way) + geo.offset(addr), bytes, size);
+        return true;
+    }
+
+    // 返回包含 addr 的缓存行数据，不在本级时返回 nullptr。不更新替换状态
+    const uint8_t* peek_line(uint32_t addr) const {
+        uint32_t set;
+        int way = find_way(addr, set);
+        return way < 0 ? nullptr : data.line(set * geo.ways() + way);
+    }
+
+    // 包含 addr 的缓存行在本级且为脏时返回 true
+    bool is_dirty(uint32_t addr) const {
+        uint32_t set;
+        int way = find_way(addr, set);
+        return way >= 0 && tags.is_dirty(set, way);
+    }
+
+    // 清除包含 addr 的缓存行的脏位（数据已由别处写回下一级）。不更新替换状态
+    void clean(uint32_t addr) {
+        uint32_t set;
+        int way = find_way(addr, set);
+        if (way >= 0) {
+            tags.clear_dirty(set, way);
+        }
+    }
+
+    // 填充包含 addr 的整条缓存行（bytes 为本级缓存行大小），dirty 为填入后的脏位。
+    // 优先使用组内无效的路，否则由替换策略选出。替换出有效行时把它的地址、
+    // 脏位和数据复制到 victim_addr / victim_dirty / victim（至少本级缓存行大小），返回 true
+    bool fill_line(uint32_t addr, const uint8_t* bytes, bool dirty,
+                   uint32_t& victim_addr, bool& victim_dirty, uint8_t* victim) {
+        uint32_t tag;
+        uint32_t set = geo.split(addr, tag);
+        int way = tags.find(set, tag);
+        if (way >= 0) {
+            // 已在本级：保留现有数据（可能比 bytes 更新），除非填入的是脏数据
+            policy.on_hit(set, way);
+            if (dirty) {
+                std::memcpy(data.line(set * geo.ways() + way), bytes, geo.line_size());
+                tags.mark_dirty(set, way);
+            }
+            return false;
+        }
+
+        way = tags.find_invalid(set);
+        if (way < 0) {
+            way = policy.victim(set);
+        }
+        policy.on_fill(set, way);
+
+        uint8_t* line = data.line(set * geo.ways() + way);
+        bool evicted = tags.is_valid(set, way);
+        if (evicted) {
+            victim_addr = geo.join(tags.tag_at(set, way), set);
+            victim_dirty = tags.is_dirty(set, way);
+            std::memcpy(victim, line, geo.line_size());
+        }
+
+        tags.insert(set, way, tag);
+        if (dirty) {
+            tags.mark_dirty(set, way);
+        }
+        std::memcpy(line, bytes, geo.line_size());
+        return evicted;
+    }
+
+    // 使包含 addr 的缓存行失效。在本级时返回 true，并把脏位和数据复制到 dirty / bytes
+    bool invalidate(uint32_t addr, bool& dirty, uint8_t* bytes) {
+        uint32_t set;
+        int way = find_way(addr, set);
+        if (way < 0) {
+            return false;
+        }
+        dirty = tags.is_dirty(set, way);
+        std::memcpy(bytes, data.line(set * geo.ways() + way), geo.line_size());
+        tags.invalidate(set, way);
+        return true;
+    }
+
+    uint32_t get_line_size() const { return geo.line_size(); }
+
+    // 缓存行数据实际放在大页上（配置了 huge_pages 且系统提供了大页）
+    bool on_huge_pages() const { return data.on_huge_pages(); }
+
+private:
+    // 在地址所属的组中查找缓存行，返回命中的路，未命中返回 -1
+    int find_way(uint32_t addr, uint32_t& set) const {
+        uint32_t tag;
+        set = geo.split(addr, tag);
+        return tags.find(set, tag);
+    }
+
+    Geometry geo;                             // 地址拆分
+    TagStore tags;                            // 标签和有效位
+    LineArena data;                           // sets * ways 条缓存行数据，按组和路索引
+    Policy policy;
+};
+
+// 专门实例化的常用几何参数（行大小, 组数, 路数），包括默认配置的两级。
+// 配置与其中某一项完全相同时使用对应的专用代码，否则走通用的实现
+template <class... Ts> struct TypeList {};
+
+typedef TypeList<FixedGeometry<64, 8, 2>,      // 1 KiB 2 路（默认 L1）
+                 FixedGeometry<64, 8, 4>,      // 2 KiB 4 路（默认 L2）
+                 FixedGeometry<64, 64, 8>,     // 32 KiB 8 路
+                 FixedGeometry<64, 1024, 16> > // 1 MiB 16 路
+    CommonGeometries;
+
+// 一种替换策略的全部实例：每个常用几何参数一份，再加通用的两份
+template <class Policy, class Geometries> struct PolicyLevels;
+template <class Policy, class... Geometries>
+struct PolicyLevels<Policy, TypeList<Geometries...> > {
+    typedef TypeList<CacheLevel<Policy, Geometries>..., CacheLevel<Policy, DynamicGeometry>,
+                     CacheLevel<Policy, FastmodGeometry> > type;
+};
+
+// 把若干 TypeList 拼接成一个 std::variant
+template <class... Lists> struct VariantOf;
+template <class... Ts>
+struct VariantOf<TypeList<Ts...> > {
+    typedef std::variant<Ts...> type;
+};
+template <class... As, class... Bs, class... Rest>
+struct VariantOf<TypeList<As...>, TypeList<Bs...>, Rest...> : VariantOf<TypeList<As..., Bs...>, Rest...> {};
+
+// 替换策略和几何参数在运行时选定的一级缓存。每种组合各实例化一份 CacheLevel，
+// 由 std::visit 按类型分派（编译为跳转表），每级内部仍然没有虚函数
+typedef VariantOf<PolicyLevels<LruPolicy, CommonGeometries>::type,
+                  PolicyLevels<TreePlruPolicy, CommonGeometries>::type,
+                  PolicyLevels<SrripPolicy, CommonGeometries>::type,
+                  PolicyLevels<BrripPolicy, CommonGeometries>::type,
+                  PolicyLevels<DrripPolicy, CommonGeometries>::type,
+                  PolicyLevels<FifoPolicy, CommonGeometries>::type,
+                  PolicyLevels<RandomPolicy, CommonGeometries>::type>::type AnyCacheLevel;
+
+// 在常用几何参数中查找与配置相同的一项，找不到时按组数是否为 2 的幂选用通用实现
+template <class Policy, class... Geometries>
+AnyCacheLevel make_policy_level(const CacheLevelConfig& cfg, uint32_t seed, TypeList<Geometries...>) {
+    std::optional<AnyCacheLevel> level;
+    ((!level && Geometries::matches(cfg)
+          ? (level.emplace(std::in_place_type<CacheLevel<Policy, Geometries> >, cfg.size, cfg.line_size, cfg.ways,
+                           seed, cfg.huge_pages), 0)
+          : 0), ...);
+    if (!level && DynamicGeometry::matches(cfg)) {
+        level.emplace(std::in_place_type<CacheLevel<Policy> >, cfg.size, cfg.line_size, cfg.ways, seed,
+                      cfg.huge_pages);
+    } else if (!level) {
+        level.emplace(std::in_place_type<CacheLevel<Policy, FastmodGeometry> >, cfg.size, cfg.line_size, cfg.ways,
+                      seed, cfg.huge_pages);
+    }
+    return std::move(*level);
+}
+
+inline AnyCacheLevel make_cache_level(const CacheLevelConfig& cfg, uint32_t seed) {
+    switch (cfg.policy) {
+    case REPLACE_TREE_PLRU:
+        return make_policy_level<TreePlruPolicy>(cfg, seed, CommonGeometries());
+    case REPLACE_SRRIP:
+        return make_policy_level<SrripPolicy>(cfg, seed, CommonGeometries());
+    case REPLACE_BRRIP:
+        return make_policy_level<BrripPolicy>(cfg, seed, CommonGeometries());
+    case REPLACE_DRRIP:
+        return make_policy_level<DrripPolicy>(cfg, seed, CommonGeometries());
+    case REPLACE_FIFO:
+        return make_policy_level<FifoPolicy>(cfg, seed, CommonGeometries());
+    case REPLACE_RANDOM:
+        return make_policy_level<RandomPolicy>(cfg, seed, CommonGeometries());
+    case REPLACE_LRU:
+    default:
+        return make_policy_level<LruPolicy>(cfg, seed, CommonGeometries());
+    }
+}
+
+#endif
@@ -0,0 +1,97 @@
+#include "dram.hpp"
+
+#include <algorithm>
+
+Dram::Dram(const DramConfig& config)
+    : config(config),
+      banks(config.channels * config.ranks * config.banks),
+      bus_free(config.channels, 0) {}
+
+Dram::Location Dram::decode(uint32_t addr) const {
+    uint32_t rest = addr / config.row_size; // 去掉 column
+    Location loc;
+    loc.channel = rest % config.channels;
+    rest /= config.channels;
+    uint32_t bank = rest % config.banks;
+    rest /= config.banks;
+    uint32_t rank = rest % config.ranks;
+    loc.row = rest / config.ranks;
+    loc.bank = rank * config.banks + bank;
+    return loc;
+}
+
+// 双沿传输，每周期传 2 * bus_width 字节
+uint32_t Dram::burst_cycles(uint32_t bytes) const {
+    uint32_t per_cycle = 2 * config.bus_width;
+    return std::max<uint32_t>(1, (bytes + per_cycle - 1) / per_cycle);
+}
+
+uint32_t Dram::bank_index(uint32_t addr) const {
+    Location loc = decode(addr);
+    return loc.channel * config.ranks * config.banks + loc.bank;
+}
+
+RowResult Dram::classify(uint32_t addr) const {
+    Location loc = decode(addr);
+    const Bank& bank = banks[loc.channel * config.ranks * config.banks + loc.bank];
+    if (!bank.open) {
+        return ROW_MISS;
+    }
+    return bank.row == loc.row ? ROW_HIT : ROW_CONFLICT;
+}
+
+uint64_t Dram::access(uint32_t addr, bool write, uint32_t bytes, uint64_t now) {
+    Location loc = decode(addr);
+    Bank& bank = banks[loc.channel * config.ranks * config.banks + loc.bank];
+    uint64_t start = std::max(now, bank.ready);
+    uint64_t column; // 列命令发出的周期
+
+    switch (classify(addr)) {
+    case ROW_HIT:
+        row_hits++;
+        column = start;
+        break;
+    case ROW_MISS:
+        row_misses++;
+        bank.activated = start;
+        column = start + config.tRCD;
+        break;
+    default: {
+        row_conflicts++;
+        uint64_t precharge = std::max(start, bank.activated + config.tRAS);
+        bank.activated = precharge + config.tRP;
+        column = bank.activated + config.tRCD;
+        break;
+    }
+    }
+
+    // 数据在 tCAS 之后经过通道总线传输
+    uint64_t transfer = std::max(column + config.tCAS, bus_free[loc.channel]);
+    uint64_t done = transfer + burst_cycles(bytes);
+    bus_free[loc.channel] = done;
+
+    if (config.policy == DramConfig::OPEN_PAGE) {
+        bank.open = true;
+        bank.row = loc.row;
+        bank.ready = column + burst_cycles(bytes);
+    } else {
+        // 自动预充电：满足 tRAS 后关闭行
+        bank.open = false;
+        bank.ready = std::max(done, bank.activated + config.tRAS) + config.tRP;
+    }
+
+    if (write) {
+        writes++;
+    } else {
+        reads++;
+    }
+    return done;
+}
+
+void Dram::print_stats(std::ostream& os) const {
+    os << std::dec
+       << "DRAM reads: " << reads << ", writes: " << writes << std::endl
+       << "DRAM row hits: " << row_hits
+       << ", row misses: " << row_misses
+       << ", row conflicts: " << row_conflicts << std::endl;
+}
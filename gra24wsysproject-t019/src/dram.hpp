@@ -0,0 +1,83 @@
+#ifndef DRAM_HPP
+#define DRAM_HPP
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// DRAM 配置，时序参数以 Memory 时钟周期为单位
+struct DramConfig {
+    enum PagePolicy {
+        OPEN_PAGE,   // 访问后保持行打开
+        CLOSED_PAGE  // 访问后自动预充电
+    };
+
+    uint32_t channels = 1;
+    uint32_t ranks = 1;
+    uint32_t banks = 8;          // 每个 rank 的 bank 数
+    uint32_t row_size = 2048;    // 每行字节数
+    uint32_t bus_width = 8;      // 数据总线宽度（字节），双沿传输
+    uint32_t tRCD = 2;           // 激活到列访问
+    uint32_t tCAS = 2;           // 列访问到数据
+    uint32_t tRP = 2;            // 预充电
+    uint32_t tRAS = 4;           // 激活到预充电的最短时间
+    PagePolicy policy = OPEN_PAGE;
+};
+
+// 行缓冲访问结果
+enum RowResult {
+    ROW_HIT,      // 目标行已打开
+    ROW_MISS,     // bank 空闲，需要激活
+    ROW_CONFLICT  // 其他行打开，需要先预充电
+};
+
+// 分 channel / rank / bank 的 DRAM 时序模型
+// 地址映射（高位到低位）：row | rank | bank | channel | column
+class Dram {
+public:
+    explicit Dram(const DramConfig& config);
+
+    // 在 now 周期发起一次访问，返回数据传输完成的周期
+    uint64_t access(uint32_t addr, bool write, uint32_t bytes, uint64_t now);
+
+    // 查询访问在当前行缓冲状态下的结果，不改变状态
+    RowResult classify(uint32_t addr) const;
+
+    // 全局 bank 编号（channel, rank, bank 展平）
+    uint32_t bank_index(uint32_t addr) const;
+    uint32_t bank_count() const { return banks.size(); }
+
+    // 目标 bank 在 now 周期能否接受新命令
+    bool bank_ready(uint32_t addr, uint64_t now) const { return banks[bank_index(addr)].ready <= now; }
+
+    void print_stats(std::ostream& os) const;
+
+    uint64_t row_hits = 0;
+    uint64_t row_misses = 0;
+    uint64_t row_conflicts = 0;
+    uint64_t reads = 0;
+    uint64_t writes = 0;
+
+private:
+    struct Bank {
+        bool open = false;
+        uint32_t row = 0;
+        uint64_t ready = 0;      // 下一条命令最早可发出的周期
+        uint64_t activated = 0;  // 最近一次激活的周期（tRAS）
+    };
+
+    struct Location {
+        uint32_t channel;
+        uint32_t bank;   // 通道内的 bank 编号（rank * banks + bank）
+        uint32_t row;
+    };
+
+    Location decode(uint32_t addr) const;
+    uint32_t burst_cycles(uint32_t bytes) const;
+
+    DramConfig config;
+    std::vector<Bank> banks;           // channels * ranks * banks
+    std::vector<uint64_t> bus_free;    // 每个通道数据总线空闲的周期
+};
+
+#endif
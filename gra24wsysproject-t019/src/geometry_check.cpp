@@ -0,0 +1,140 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "cache_geometry.hpp"
+
+// 用每次都做除法的 % 和 / 穷举校验 FastmodGeometry：对 32 位的每个缓存行号，
+// 组号、标签和由二者还原的行号都必须精确。行大小取 1，地址即行号，覆盖全部 2^32 个值。
+// 用法：geometry_check [组数]...，不给组数时校验下面的默认列表（每个组数十几秒）。
+// geometry_check bench [组数]：比较拆分地址的速度，组数不是 2 的幂时用 FastmodGeometry（默认 48 组），
+// 与相邻的 2 的幂组数的 DynamicGeometry 和直接用 % / / 的拆分对照。
+// 不依赖 SystemC，单独编译：g++ -std=c++17 -O2 geometry_check.cpp -o geometry_check
+
+// 常见的非 2 的幂组数（如 3 MiB 16 路的 3072 组），加上小组数和接近 32 位上限的组数
+static const uint32_t DEFAULT_SETS[] = {
+    3, 5, 6, 7, 12, 20, 24, 48, 96, 100, 192, 384, 1000, 1536, 3072, 6144, 12288, 24576,
+    65535, 65537, 1000003, 0x80000001u, 0xffffffffu,
+};
+
+// 返回不一致的行号个数，只打印前几个
+static uint64_t check_sets(uint32_t sets) {
+    FastmodGeometry geo(1, sets, 1);
+    uint64_t errors = 0;
+    uint32_t line = 0;
+    do {
+        uint32_t tag;
+        uint32_t set = geo.split(line, tag);
+        if (set != line % sets || tag != line / sets || geo.join(tag, set) != line) {
+            if (++errors <= 5) {
+                std::cerr << "sets " << std::dec << sets << ", line 0x" << std::hex << line << ": set " << std::dec
+                          << set << " tag " << tag << ", expected set " << line % sets << " tag " << line / sets
+                          << std::endl;
+            }
+        }
+    } while (++line != 0);
+    return errors;
+}
+
+// 直接用除法拆分地址，作为速度的对照
+class DivideGeometry {
+public:
+    DivideGeometry(uint32_t line_size, uint32_t sets, uint32_t /*ways*/)
+        : set_count(sets), line_shift(log2_exact(line_size)) {}
+
+    uint32_t split(uint32_t addr, uint32_t& tag) const {
+        uint32_t line = addr >> line_shift;
+        tag = line / set_count;
+        return line % set_count;
+    }
+
+private:
+    uint32_t set_count;
+    uint32_t line_shift;
+};
+
+static const uint32_t BENCH_ADDRS = 1 << 16;  // 地址表的大小（放得进 L1/L2）
+static const uint32_t BENCH_ROUNDS = 2000;
+
+// 对同一张随机地址表反复拆分，返回每次拆分的纳秒数。组号和标签累加进 sink，避免被优化掉
+template <class Geometry>
+static double bench_split(const Geometry& geo, const std::vector<uint32_t>& addrs, uint64_t& sink) {
+    auto begin = std::chrono::steady_clock::now();
+    uint64_t sum = 0;
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        for (uint32_t addr : addrs) {
+            uint32_t tag;
+            sum += geo.split(addr, tag) + tag;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    sink += sum;
+    return seconds * 1e9 / ((double)BENCH_ROUNDS * addrs.size());
+}
+
+static int bench(uint32_t sets) {
+    uint32_t pow2 = 1;
+    while (pow2 * 2 <= sets) {
+        pow2 *= 2;
+    }
+    std::vector<uint32_t> addrs(BENCH_ADDRS);
+    uint32_t state = 12345;
+    for (uint32_t& addr : addrs) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        addr = state;
+    }
+
+    // 几何参数在运行时构造，与 CacheLevel 的通用路径相同，编译器不能把组数当作常量
+    uint64_t sink = 0;
+    double dynamic = bench_split(DynamicGeometry(64, pow2, 8), addrs, sink);
+    double fastmod = bench_split(FastmodGeometry(64, sets, 8), addrs, sink);
+    double divide = bench_split(DivideGeometry(64, sets, 8), addrs, sink);
+    std::cout << "DynamicGeometry (" << pow2 << " sets): " << dynamic << " ns per split" << std::endl;
+    std::cout << "FastmodGeometry (" << sets << " sets): " << fastmod << " ns per split" << std::endl;
+    std::cout << "% and / (" << sets << " sets): " << divide << " ns per split" << std::endl;
+    std::cout << "(checksum " << sink << ")" << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::strcmp(argv[1], "bench") == 0) {
+        uint32_t sets = argc > 2 ? std::strtoul(argv[2], nullptr, 0) : 48;
+        if (sets < 2) {
+            std::cerr << "Set count must be at least 2" << std::endl;
+            return 1;
+        }
+        return bench(sets);
+    }
+
+    std::vector<uint32_t> sets_list;
+    for (int i = 1; i < argc; i++) {
+        unsigned long sets = std::strtoul(argv[i], nullptr, 0);
+        if (sets < 2 || sets > UINT32_MAX) {
+            std::cerr << "Set count must be between 2 and 2^32 - 1: " << argv[i] << std::endl;
+            return 1;
+        }
+        sets_list.push_back(sets);
+    }
+    if (sets_list.empty()) {
+        sets_list.assign(std::begin(DEFAULT_SETS), std::end(DEFAULT_SETS));
+    }
+
+    uint64_t failed = 0;
+    for (uint32_t sets : sets_list) {
+        uint64_t errors = check_sets(sets);
+        std::cout << "sets " << sets << ": " << (errors ? "FAILED" : "ok");
+        if (errors) {
+            std::cout << " (" << errors << " mismatches)";
+        }
+        std::cout << std::endl;
+        failed += errors != 0;
+    }
+    std::cout << sets_list.size() - failed << " of " << sets_list.size() << " set counts exact over all 2^32 lines"
+              << std::endl;
+    return failed ? 1 : 0;
+}
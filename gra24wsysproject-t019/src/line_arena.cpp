@@ -0,0 +1,64 @@
+#include "line_arena.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <sys/mman.h>
+
+static const size_t HUGE_PAGE = 2 * 1024 * 1024;
+
+LineArena::LineArena(size_t lines, uint32_t line_size, bool huge_pages)
+    : base(nullptr), bytes(0),
+      stride((line_size + HOST_LINE - 1) / HOST_LINE * HOST_LINE),
+      mapped(false), huge(false) {
+    bytes = lines * stride;
+    if (bytes == 0) {
+        return;
+    }
+
+    if (huge_pages) {
+        // 先尝试显式大页，失败时退回普通匿名映射并建议内核使用透明大页
+        size_t rounded = (bytes + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+        void* p = mmap(nullptr, rounded, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            huge = true;
+        } else {
+            p = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p != MAP_FAILED) {
+                huge = madvise(p, rounded, MADV_HUGEPAGE) == 0;
+            }
+        }
+        if (p != MAP_FAILED) {
+            base = static_cast<uint8_t*>(p); // 匿名映射本身就是全零
+            bytes = rounded;
+            mapped = true;
+            return;
+        }
+    }
+
+    base = static_cast<uint8_t*>(std::aligned_alloc(HOST_LINE, bytes));
+    if (!base) {
+        throw std::bad_alloc();
+    }
+    std::memset(base, 0, bytes);
+}
+
+LineArena::LineArena(LineArena&& other)
+    : base(other.base), bytes(other.bytes), stride(other.stride),
+      mapped(other.mapped), huge(other.huge) {
+    other.base = nullptr;
+    other.bytes = 0;
+}
+
+LineArena::~LineArena() {
+    if (!base) {
+        return;
+    }
+    if (mapped) {
+        munmap(base, bytes);
+    } else {
+        std::free(base);
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef LINE_ARENA_HPP
+#define LINE_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// 一级缓存全部缓存行数据的连续存储区：一次分配，按主机缓存行（64 字节）
+// 对齐，第 i 条缓存行位于 base + i * stride。可选用大页作为后备存储
+class LineArena {
+public:
+    static const uint32_t HOST_LINE = 64;
+
+    LineArena(size_t lines, uint32_t line_size, bool huge_pages = false);
+    ~LineArena();
+
+    LineArena(LineArena&& other);
+    LineArena(const LineArena&) = delete;
+    LineArena& operator=(const LineArena&) = delete;
+    LineArena& operator=(LineArena&&) = delete;
+
+    uint8_t* line(size_t index) { return base + index * stride; }
+    const uint8_t* line(size_t index) const { return base + index * stride; }
+
+    bool on_huge_pages() const { return huge; }
+
+private:
+    uint8_t* base;
+    size_t bytes;     // 分配的总字节数
+    uint32_t stride;  // 相邻缓存行的间距，补齐到 HOST_LINE 的倍数
+    bool mapped;      // 通过 mmap 分配（否则为 aligned_alloc）
+    bool huge;        // 实际使用了大页
+};
+
+#endif
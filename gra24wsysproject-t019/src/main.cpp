@@ -1,73 +1,10 @@
 #include <systemc.h>
 #include <vector>
 #include <iostream>
+#include <string>
+#include <cstdlib>
 
-// Memory 模块定义
-class Memory : public sc_module {
-public:
-    // Ports
-    sc_in<bool> clk;          // 时钟信号
-    sc_in<bool> read;         // 读操作信号
-    sc_in<bool> write;        // 写操作信号
-    sc_in<uint32_t> address;  // 地址信号
-    sc_in<uint32_t> w_data;   // 写入数据信号
-    sc_out<uint32_t> r_data;  // 读出数据信号
-    sc_out<bool> ready;       // 操作完成信号
-
-    SC_CTOR(Memory);
-
-private:
-    // 内存数据结构
-    std::vector<std::vector<uint8_t> > memory; // 模拟的分页内存
-    int page_size = 4 * 1024;                 // 每页大小：4 KiB
-    int page_num = 1024 * 1024;               // 页数：2^20
-
-    void process_memory(); // 内存操作逻辑
-};
-
-// 构造函数：初始化内存并定义线程
-Memory::Memory(sc_module_name name) : sc_module(name) {
-    // 初始化分页内存
-    memory.resize(page_num, std::vector<uint8_t>(page_size, 0));
-
-    // 定义线程
-    SC_THREAD(process_memory);
-    sensitive << clk.pos(); // 对时钟上升沿敏感
-}
-
-// 内存操作逻辑
-void Memory::process_memory() {
-    while (true) {
-        wait(); // 等待时钟上升沿
-        ready.write(false);
-
-        uint32_t addr = address.read();
-        int page = addr / page_size;
-        int position = addr % page_size;
-        uint32_t data = 0;
-
-        if (read.read() && write.read()) {
-            std::cerr << "Simultaneous read and write detected!" << std::endl;
-        } else if (read.read()) {
-            // 读操作
-            for (int i = 3; i >= 0; i--) { // 每次读取 4 字节
-                data = (data << 8) | memory[page][position + i];
-            }
-            r_data.write(data);
-            std::cout << "Read data: " << std::hex << data << " from address: " << addr << std::endl;
-        } else if (write.read()) {
-            // 写操作
-            data = w_data.read();
-            for (int i = 0; i < 4; i++) { // 每次写入 4 字节
-                memory[page][position + i] = data & 0xFF;
-                data >>= 8;
-            }
-            std::cout << "Written data: " << std::hex << w_data.read() << " to address: " << addr << std::endl;
-        }
-
-        ready.write(true); // 操作完成
-    }
-}
+#include "memory.hpp"
 
 // 主程序
 int sc_main(int argc, char** argv) {
@@ -75,13 +12,29 @@ int sc_main(int argc, char** argv) {
     std::cout << "Simulation starts" << std::endl;
 
     // 定义信号
-    sc_signal<bool> w_signal, r_signal, ready_signal;
-    sc_signal<uint32_t> wdata, addr, rdata;
+    sc_signal<bool> w_signal, r_signal, ready_signal, full_signal;
+    sc_signal<uint32_t> wdata, addr, rdata, req_id, resp_id, burst_len;
+    sc_signal<MemLine> wline, rline;
     sc_clock clk_signal("clk_signal", 10, SC_NS); // 时钟周期 10ns
 
     // 实例化 Memory 模块
     Memory memory("Memory");
 
+    // 加载命令行指定的内存镜像：<文件>[@地址]，ELF 文件忽略地址
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        std::string::size_type at = arg.find('@');
+        uint32_t base = 0;
+        if (at != std::string::npos) {
+            base = std::strtoul(arg.c_str() + at + 1, nullptr, 0);
+            arg = arg.substr(0, at);
+        }
+        if (!memory.load_image(arg, base)) {
+            return 1;
+        }
+        std::cout << "Loaded memory image " << arg << " at address: " << std::hex << base << std::endl;
+    }
+
     // 信号连接
     memory.clk(clk_signal);
     memory.write(w_signal);
@@ -89,7 +42,26 @@ int sc_main(int argc, char** argv) {
     memory.w_data(wdata);
     memory.r_data(rdata);
     memory.address(addr);
+    memory.req_id(req_id);
+    memory.burst_len(burst_len);
+    memory.w_line(wline);
+    memory.r_line(rline);
+    memory.resp_id(resp_id);
     memory.ready(ready_signal);
+    memory.full(full_signal);
+
+    // 请求只保持一个周期，然后等待 ready
+    auto run_until_ready = [&]() {
+        int cycles = 1;
+        sc_start(10, SC_NS);
+        w_signal.write(false);
+        r_signal.write(false);
+        while (!ready_signal.read()) {
+            sc_start(10, SC_NS);
+            cycles++;
+        }
+        std::cout << "Latency: " << std::dec << cycles << " cycles" << std::endl;
+    };
 
     // 测试用例 1：写入数据
     std::cout << "[TEST 1] Writing data 0x12345678 to address 0x00000000" << std::endl;
@@ -97,13 +69,13 @@ int sc_main(int argc, char** argv) {
     addr.write(0x00000000);
     w_signal.write(true);
     r_signal.write(false);
-    sc_start(10, SC_NS); // 模拟 10ns
+    run_until_ready();
 
     // 测试用例 2：读取数据
     std::cout << "[TEST 2] Reading data from address 0x00000000" << std::endl;
     w_signal.write(false);
     r_signal.write(true);
-    sc_start(10, SC_NS); // 模拟 10ns
+    run_until_ready();
 
     std::cout << "Read data: " << std::hex << rdata.read() << std::endl;
 
@@ -113,17 +85,65 @@ int sc_main(int argc, char** argv) {
     addr.write(0x00001000);
     w_signal.write(true);
     r_signal.write(false);
-    sc_start(10, SC_NS); // 模拟 10ns
+    run_until_ready();
 
     // 测试用例 4：读取写入的数据
     std::cout << "[TEST 4] Reading data from address 0x00001000" << std::endl;
     w_signal.write(false);
     r_signal.write(true);
-    sc_start(10, SC_NS); // 模拟 10ns
+    run_until_ready();
+
+    std::cout << "Read data: " << std::hex << rdata.read() << std::endl;
+
+    // 测试用例 5：读取同一 bank 的另一行（行冲突），未写过的地址读为 0
+    std::cout << "[TEST 5] Reading data from address 0x00010000 (row conflict)" << std::endl;
+    addr.write(0x00010000);
+    r_signal.write(true);
+    run_until_ready();
 
     std::cout << "Read data: " << std::hex << rdata.read() << std::endl;
 
+    // 测试用例 6：连续发出三个读请求。0x00000000 与 0x00020000 在同一 bank 的不同行，
+    // 0x00000040 与第一个请求同行，FR-FCFS 会让它越过 0x00020000 先完成
+    std::cout << "[TEST 6] Back-to-back reads to 0x00000000, 0x00020000, 0x00000040 (FR-FCFS)" << std::endl;
+    const uint32_t burst[3] = {0x00000000, 0x00020000, 0x00000040};
+    for (int i = 0; i < 3; i++) {
+        addr.write(burst[i]);
+        req_id.write(i + 1);
+        r_signal.write(true);
+        sc_start(10, SC_NS);
+    }
+    r_signal.write(false);
+    for (int done = 0; done < 3; ) {
+        sc_start(10, SC_NS);
+        if (ready_signal.read()) {
+            std::cout << "Response for request " << std::dec << resp_id.read() << std::endl;
+            done++;
+        }
+    }
+
+    // 测试用例 7：突发写入并读回一整条 64 字节缓存行，一次请求完成
+    std::cout << "[TEST 7] Burst writing and reading a 64-byte line at address 0x00002000" << std::endl;
+    MemLine line;
+    line.size = 64;
+    for (uint32_t i = 0; i < line.size; i++) {
+        line.bytes[i] = i;
+    }
+    wline.write(line);
+    burst_len.write(line.size);
+    addr.write(0x00002000);
+    req_id.write(0);
+    w_signal.write(true);
+    run_until_ready();
+
+    r_signal.write(true);
+    run_until_ready();
+    burst_len.write(0);
+
+    std::cout << "Line read back " << (rline.read() == line ? "matches" : "differs") << std::endl;
+
     // 结束仿真
+    memory.print_stats(std::cout);
     std::cout << "Simulation ends" << std::endl;
 
     return 0;
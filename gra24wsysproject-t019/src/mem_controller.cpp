@@ -0,0 +1,113 @@
+#include "mem_controller.hpp"
+
+#include <algorithm>
+
+MemController::MemController(const MemControllerConfig& config, const Dram& dram)
+    : config(config), dram(dram),
+      read_queues(dram.bank_count()), write_queues(dram.bank_count()) {}
+
+bool MemController::can_accept(uint32_t addr, bool write) const {
+    const BankQueues& queues = write ? write_queues : read_queues;
+    return queues[dram.bank_index(addr)].size() < config.queue_depth;
+}
+
+bool MemController::any_full() const {
+    for (size_t i = 0; i < read_queues.size(); i++) {
+        if (read_queues[i].size() >= config.queue_depth ||
+            write_queues[i].size() >= config.queue_depth) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MemController::enqueue(const MemRequest& req) {
+    if (req.write) {
+        write_queues[dram.bank_index(req.addr)].push_back(req);
+        pending_writes++;
+    } else {
+        read_queues[dram.bank_index(req.addr)].push_back(req);
+        pending_reads++;
+    }
+}
+
+// FR-FCFS：只考虑空闲的 bank，行命中优先，其次最早到达
+bool MemController::pick(const BankQueues& queues, uint64_t now, uint32_t& bank, size_t& pos) const {
+    bool found = false;
+    bool found_hit = false;
+    uint64_t oldest = 0;
+
+    for (uint32_t b = 0; b < queues.size(); b++) {
+        const std::deque<MemRequest>& queue = queues[b];
+        if (queue.empty() || !dram.bank_ready(queue.front().addr, now)) {
+            continue;
+        }
+        for (size_t i = 0; i < queue.size(); i++) {
+            bool hit = dram.classify(queue[i].addr) == ROW_HIT;
+            if (found_hit && !hit) {
+                continue;
+            }
+            if (!found || (hit && !found_hit) || queue[i].arrival < oldest) {
+                found = true;
+                found_hit = hit;
+                oldest = queue[i].arrival;
+                bank = b;
+                pos = i;
+            }
+        }
+    }
+    return found;
+}
+
+bool MemController::schedule(uint64_t now, MemRequest& req) {
+    // 写队列水位控制
+    if (!draining && pending_writes >= config.write_high) {
+        draining = true;
+        drains++;
+    } else if (draining && pending_writes <= config.write_low) {
+        draining = false;
+    }
+
+    // 平时先读后写，集中写回时先写后读
+    const bool order[2] = {draining, !draining};
+    for (int i = 0; i < 2; i++) {
+        bool write = order[i];
+        BankQueues& queues = write ? write_queues : read_queues;
+        uint32_t bank = 0;
+        size_t pos = 0;
+        if (!pick(queues, now, bank, pos)) {
+            continue;
+        }
+
+        req = queues[bank][pos];
+        queues[bank].erase(queues[bank].begin() + pos);
+        if (write) {
+            pending_writes--;
+        } else {
+            pending_reads--;
+        }
+
+        uint64_t delay = now - req.arrival;
+        issued++;
+        delay_sum += delay;
+        delay_max = std::max(delay_max, delay);
+        return true;
+    }
+    return false;
+}
+
+void MemController::sample_occupancy() {
+    uint32_t occupancy = pending_reads + pending_writes;
+    cycles++;
+    occupancy_sum += occupancy;
+    occupancy_max = std::max(occupancy_max, occupancy);
+}
+
+void MemController::print_stats(std::ostream& os) const {
+    os << std::dec
+       << "Controller queue occupancy avg: " << (cycles ? (double)occupancy_sum / cycles : 0.0)
+       << ", max: " << occupancy_max << std::endl
+       << "Controller queueing delay avg: " << (issued ? (double)delay_sum / issued : 0.0)
+       << " cycles, max: " << delay_max << " cycles" << std::endl
+       << "Controller write drains: " << drains << std::endl;
+}
@@ -0,0 +1,75 @@
+#ifndef MEM_CONTROLLER_HPP
+#define MEM_CONTROLLER_HPP
+
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <vector>
+
+#include "dram.hpp"
+#include "mem_line.hpp"
+
+// 内存控制器配置
+struct MemControllerConfig {
+    uint32_t queue_depth = 8;  // 每个 bank 的读队列 / 写队列深度
+    uint32_t write_high = 16;  // 待写请求总数达到高水位时开始集中写回
+    uint32_t write_low = 4;    // 降到低水位时停止集中写回
+};
+
+// 控制器中的一条请求
+struct MemRequest {
+    uint32_t id;
+    uint32_t addr;
+    bool write;
+    uint32_t size;     // 传输字节数：单字访问为 4，突发传输为整条缓存行
+    bool burst;        // 突发传输（整条缓存行，可能也只有 4 字节），读出的数据走 r_line
+    MemLine data;      // 写入的数据，或入队时读到的数据
+    uint64_t arrival;  // 进入队列的周期
+};
+
+// 每个 bank 一组有界读 / 写队列，FR-FCFS 调度：
+// 先选行命中的请求，再选最早到达的请求。平时读优先，
+// 待写请求超过高水位后集中写回，直到降到低水位
+class MemController {
+public:
+    MemController(const MemControllerConfig& config, const Dram& dram);
+
+    bool can_accept(uint32_t addr, bool write) const;
+    void enqueue(const MemRequest& req);
+
+    // 在 now 周期选出下一条要发给 DRAM 的请求，没有可发的请求时返回 false
+    bool schedule(uint64_t now, MemRequest& req);
+
+    bool any_full() const;
+    bool empty() const { return pending_reads == 0 && pending_writes == 0; }
+
+    // 每周期调用一次，统计队列占用
+    void sample_occupancy();
+
+    void print_stats(std::ostream& os) const;
+
+private:
+    typedef std::vector<std::deque<MemRequest> > BankQueues;
+
+    // 在一组队列中按 FR-FCFS 选择，返回 bank 编号和队列下标
+    bool pick(const BankQueues& queues, uint64_t now, uint32_t& bank, size_t& pos) const;
+
+    MemControllerConfig config;
+    const Dram& dram;
+    BankQueues read_queues;
+    BankQueues write_queues;
+    uint32_t pending_reads = 0;
+    uint32_t pending_writes = 0;
+    bool draining = false;  // 是否处于集中写回状态
+
+    // 统计
+    uint64_t cycles = 0;
+    uint64_t occupancy_sum = 0;
+    uint32_t occupancy_max = 0;
+    uint64_t issued = 0;
+    uint64_t delay_sum = 0;
+    uint64_t delay_max = 0;
+    uint64_t drains = 0;
+};
+
+#endif
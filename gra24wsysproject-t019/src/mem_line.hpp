@@ -0,0 +1,29 @@
+#ifndef MEM_LINE_HPP
+#define MEM_LINE_HPP
+
+#include <systemc.h>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// 一次突发传输搬运的数据（一整条缓存行），可以直接作为 sc_signal 的值
+struct MemLine {
+    static const uint32_t MAX_SIZE = 256; // 支持的最大缓存行（字节）
+
+    uint32_t size = 0;
+    uint8_t bytes[MAX_SIZE] = {};
+
+    bool operator==(const MemLine& other) const {
+        return size == other.size && std::memcmp(bytes, other.bytes, size) == 0;
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const MemLine& line) {
+    return os << "MemLine(" << std::dec << line.size << " bytes)";
+}
+
+inline void sc_trace(sc_trace_file*, const MemLine&, const std::string&) {
+    // 缓存行不参与波形跟踪
+}
+
+#endif
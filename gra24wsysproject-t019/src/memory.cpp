@@ -0,0 +1,110 @@
+#include "memory.hpp"
+
+#include <cstring>
+
+// 构造函数：定义线程（页面在第一次写入时才分配）
+Memory::Memory(sc_module_name name, const DramConfig& config, const MemControllerConfig& ctrl_config)
+    : sc_module(name), dram(config), controller(ctrl_config, dram) {
+    // 定义线程
+    SC_THREAD(process_memory);
+    sensitive << clk.pos(); // 对时钟上升沿敏感
+}
+
+// 接收请求。读写数据在到达时就完成，保证按到达顺序看到数据；
+// 时序由控制器的调度和 DRAM 模型决定
+void Memory::accept_request() {
+    if (skid_valid && controller.can_accept(skid.addr, skid.write)) {
+        controller.enqueue(skid);
+        skid_valid = false;
+    }
+
+    if (!read.read() && !write.read()) {
+        return;
+    }
+    if (read.read() && write.read()) {
+        std::cerr << "Simultaneous read and write detected!" << std::endl;
+        return;
+    }
+
+    MemRequest req;
+    req.id = req_id.read();
+    req.addr = address.read();
+    req.write = write.read();
+    req.burst = burst_len.read() != 0;
+    req.size = req.burst ? burst_len.read() : 4;
+    req.arrival = cycle;
+    if (req.size > MemLine::MAX_SIZE) {
+        std::cerr << "Burst length too large: " << std::dec << req.size << std::endl;
+        return;
+    }
+
+    req.data.size = req.size;
+    if (!req.write) {
+        // 读操作：单字或整条缓存行，未写过的页面读为 0
+        memory.read(req.addr, req.data.bytes, req.size);
+    } else if (req.burst) {
+        // 突发写：一次写入整条缓存行
+        std::memcpy(req.data.bytes, w_line.read().bytes, req.size);
+        memory.write(req.addr, req.data.bytes, req.size);
+    } else {
+        // 写操作：每次写入 4 字节
+        memory.write_word(req.addr, w_data.read());
+        memory.read(req.addr, req.data.bytes, 4);
+    }
+
+    if (!skid_valid && controller.can_accept(req.addr, req.write)) {
+        controller.enqueue(req);
+    } else if (!skid_valid) {
+        skid = req;
+        skid_valid = true;
+    } else {
+        std::cerr << "Memory controller overflow, request dropped: " << std::hex << req.addr << std::endl;
+    }
+}
+
+// 内存操作逻辑：每个时钟上升沿接收至多一条请求、向 DRAM 发出至多一条命令、
+// 返回至多一个响应（ready 拉高一个周期，resp_id 标明请求）。
+// 请求方只需保持 read/write 一个周期，full 为高时不要发送新请求
+void Memory::process_memory() {
+    while (true) {
+        wait(); // 等待时钟上升沿
+        cycle++;
+        ready.write(false);
+
+        accept_request();
+
+        // 突发传输的时序由 DRAM 模型按传输字节数计算
+        MemRequest req;
+        if (controller.schedule(cycle, req)) {
+            uint64_t done = dram.access(req.addr, req.write, req.size, cycle);
+            inflight.push({done, req});
+        }
+
+        if (!inflight.empty() && inflight.top().done <= cycle) {
+            const MemRequest& done = inflight.top().req;
+            uint32_t word = 0;
+            for (int i = 3; i >= 0; i--) {
+                word = (word << 8) | done.data.bytes[i];
+            }
+            if (done.burst) {
+                if (!done.write) {
+                    r_line.write(done.data);
+                }
+                std::cout << (done.write ? "Written line (" : "Read line (") << std::dec << done.size
+                          << " bytes) " << (done.write ? "to" : "from") << " address: " << std::hex << done.addr;
+            } else if (!done.write) {
+                r_data.write(word);
+                std::cout << "Read data: " << std::hex << word << " from address: " << done.addr;
+            } else {
+                std::cout << "Written data: " << std::hex << word << " to address: " << done.addr;
+            }
+            std::cout << " (id " << std::dec << done.id << ")" << std::endl;
+            resp_id.write(done.id);
+            ready.write(true); // 操作完成
+            inflight.pop();
+        }
+
+        controller.sample_occupancy();
+        full.write(skid_valid || controller.any_full());
+    }
+}
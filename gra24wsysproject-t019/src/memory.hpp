@@ -0,0 +1,71 @@
+#ifndef MEMORY_HPP
+#define MEMORY_HPP
+
+#include <systemc.h>
+#include <vector>
+#include <iostream>
+#include <string>
+#include <functional>
+#include <queue>
+
+#include "dram.hpp"
+#include "mem_controller.hpp"
+#include "mem_line.hpp"
+#include "page_store.hpp"
+
+// Memory 模块定义
+class Memory : public sc_module {
+public:
+    // Ports
+    sc_in<bool> clk;          // 时钟信号
+    sc_in<bool> read;         // 读操作信号
+    sc_in<bool> write;        // 写操作信号
+    sc_in<uint32_t> address;  // 地址信号
+    sc_in<uint32_t> w_data;   // 写入数据信号
+    sc_in<uint32_t> req_id;   // 请求编号
+    sc_in<uint32_t> burst_len; // 突发传输字节数（整条缓存行），0 表示单字访问
+    sc_in<MemLine> w_line;    // 突发写入的数据
+    sc_out<uint32_t> r_data;  // 读出数据信号
+    sc_out<MemLine> r_line;   // 突发读出的数据
+    sc_out<uint32_t> resp_id; // 完成的请求编号
+    sc_out<bool> ready;       // 操作完成信号
+    sc_out<bool> full;        // 控制器队列已满，请求方暂停发送
+
+    SC_HAS_PROCESS(Memory);
+
+    Memory(sc_module_name name, const DramConfig& config = DramConfig(),
+           const MemControllerConfig& ctrl_config = MemControllerConfig());
+
+    // 仿真开始前加载内存镜像（写时复制映射，不经过读写周期）
+    bool load_image(const std::string& path, uint32_t base) { return memory.load_image(path, base); }
+
+    // 仿真开始前直接写入一个字（不经过读写周期），例如由 PageTable 建立页表
+    void init_word(uint32_t addr, uint32_t data) { memory.write_word(addr, data); }
+
+    void print_stats(std::ostream& os) const {
+        controller.print_stats(os);
+        dram.print_stats(os);
+    }
+
+private:
+    // 已发给 DRAM、等待完成的请求
+    struct Completion {
+        uint64_t done;
+        MemRequest req;
+        bool operator>(const Completion& other) const { return done > other.done; }
+    };
+
+    // 内存数据结构
+    PageStore memory;          // 稀疏分页内存，页面按需分配
+    Dram dram;                 // DRAM 时序模型
+    MemController controller;  // 请求队列与调度
+    std::priority_queue<Completion, std::vector<Completion>, std::greater<Completion> > inflight;
+    MemRequest skid;           // 吸收 full 信号一个周期延迟内到达的请求
+    bool skid_valid = false;
+    uint64_t cycle = 0;        // 当前时钟周期
+
+    void process_memory(); // 内存操作逻辑
+    void accept_request(); // 接收本周期的请求
+};
+
+#endif
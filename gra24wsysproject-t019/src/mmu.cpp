@@ -0,0 +1,276 @@
+#include "mmu.hpp"
+
+// 构造函数：按配置建立两级 TLB 和页表遍历缓存（全相联，项数即相联度）
+Mmu::Mmu(sc_module_name name, const CacheConfig& config) : sc_module(name),
+    walk_cache(config.walk_cache, config.walk_cache)
+{
+    for (int i = 0; i < 2; i++) {
+        tlbs.emplace_back(config.tlbs[i].entries, config.tlbs[i].ways);
+        latencies[i] = config.tlbs[i].latency;
+    }
+
+    SC_THREAD(process_mmu);
+    sensitive << clk.pos();
+}
+
+void Mmu::set_root(uint32_t root) {
+    root_table = root;
+    for (Tlb& tlb : tlbs) {
+        tlb.flush();
+    }
+    walk_cache.flush();
+}
+
+// 每个时钟上升沿：收取缓存返回的响应（页表项交给遍历器），接收至多一条请求并查 TLB，
+// 遍历器空闲时开始下一次遍历，向缓存发出至多一条请求（遍历器优先），向请求方返回至多一个响应
+void Mmu::process_mmu() {
+    while (true) {
+        wait();
+        cycle++;
+        ready.write(false);
+        cache_read.write(false);
+        cache_write.write(false);
+
+        receive_cache();
+        if (read.read() || write.read()) {
+            accept({write.read(), address.read(), w_data.read(), req_id.read(), pc.read(), cycle, false, 0, 0});
+        }
+        if (!walking) {
+            start_walk();
+        }
+        issue();
+        respond();
+
+        full.write(accesses.size() + 1 >= MAX_PENDING);
+    }
+}
+
+void Mmu::receive_cache() {
+    if (!cache_ready.read()) {
+        return;
+    }
+    uint32_t id = cache_resp_id.read();
+    if (walking && walk.waiting && id == walk.id) {
+        step_walk(cache_r_data.read());
+        return;
+    }
+    auto it = inflight.find(id);
+    if (it == inflight.end()) {
+        std::cerr << "Unexpected cache response " << std::dec << id << std::endl;
+        return;
+    }
+    responses.push_back({it->second, cache_r_data.read()});
+    inflight.erase(it);
+}
+
+// 查两级 TLB：L1 命中时 L1 的延迟之后发出，L2 命中时填入 L1，两级延迟之后发出；
+// 都未命中时这一页排队等待遍历
+void Mmu::accept(const Access& req) {
+    Access acc = req;
+    uint32_t paddr = 0;
+    uint32_t shift = 0;
+    uint64_t latency = latencies[0];
+    tlb_lookups[0]++;
+    bool hit = tlbs[0].lookup(acc.vaddr, paddr, shift);
+    if (hit) {
+        tlb_hits[0]++;
+    } else if (tlbs[1].enabled()) {
+        tlb_lookups[1]++;
+        latency += latencies[1];
+        hit = tlbs[1].lookup(acc.vaddr, paddr, shift);
+        if (hit) {
+            tlb_hits[1]++;
+            tlbs[0].insert(acc.vaddr, shift, paddr & ~((1u << shift) - 1));
+        }
+    }
+
+    if (hit) {
+        acc.translated = true;
+        acc.paddr = paddr;
+        acc.issue = cycle + latency - 1;
+    } else if (!queued(acc.vaddr >> PAGE_SHIFTS[0])) {
+        walk_queue.push_back(acc.vaddr >> PAGE_SHIFTS[0]);
+    }
+    accesses.push_back(acc);
+}
+
+bool Mmu::queued(uint32_t vpn) const {
+    if (walking && walk.vaddr >> PAGE_SHIFTS[0] == vpn) {
+        return true;
+    }
+    for (uint32_t queued_vpn : walk_queue) {
+        if (queued_vpn == vpn) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 取出下一个等待遍历的页。前面的遍历可能已经填入了覆盖它的大页，这时不用再遍历。
+// 页表遍历缓存先查第 2 级页表项（直接读第 1 级页表），再查第 3 级页表项
+void Mmu::start_walk() {
+    while (!walk_queue.empty()) {
+        uint32_t vaddr = walk_queue.front() << PAGE_SHIFTS[0];
+        walk_queue.pop_front();
+        uint32_t paddr = 0;
+        uint32_t shift = 0;
+        if (tlbs[0].lookup(vaddr, paddr, shift)) {
+            replay();
+            continue;
+        }
+
+        walk = {vaddr, PT_LEVELS, root_table, cycle, false, 0};
+        walking = true;
+        walks++;
+        uint32_t table = 0;
+        if (walk_cache.lookup_page(vaddr, pt_shift(2), table)) {
+            walk.level = 1;
+            walk.table = table;
+            walk_cache_hits[0]++;
+        } else if (walk_cache.lookup_page(vaddr, pt_shift(3), table)) {
+            walk.level = 2;
+            walk.table = table;
+            walk_cache_hits[1]++;
+        }
+        return;
+    }
+}
+
+// 遍历器读到一个页表项：叶子项（第 1 级，或置了 PTE_LARGE 的大页）填入两级 TLB 并结束遍历，
+// 否则记入页表遍历缓存，下一个周期读下一级
+void Mmu::step_walk(uint32_t pte) {
+    walk.waiting = false;
+    if (!(pte & PTE_PRESENT)) {
+        fault();
+        return;
+    }
+    if (walk.level > 1 && !(pte & PTE_LARGE)) {
+        walk.table = pte & PTE_ADDR_MASK;
+        walk_cache.insert(walk.vaddr, pt_shift(walk.level), walk.table);
+        walk.level--;
+        return;
+    }
+
+    uint32_t shift = pt_shift(walk.level);
+    uint32_t base = pte & PTE_ADDR_MASK & ~((1u << shift) - 1);
+    for (Tlb& tlb : tlbs) {
+        tlb.insert(walk.vaddr, shift, base);
+    }
+    walked_pages[walk.level - 1]++;
+    walk_cycles += cycle - walk.start;
+    walking = false;
+    replay();
+}
+
+// 缺页：等待这一页的访问不访问缓存，以数据 0 完成
+void Mmu::fault() {
+    std::cerr << "Page fault at virtual address " << std::hex << walk.vaddr << std::endl;
+    page_faults++;
+    walk_cycles += cycle - walk.start;
+    walking = false;
+    for (auto it = accesses.begin(); it != accesses.end(); ) {
+        if (!it->translated && it->vaddr >> PAGE_SHIFTS[0] == walk.vaddr >> PAGE_SHIFTS[0]) {
+            responses.push_back({it->id, 0});
+            it = accesses.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// TLB 填入新的一页后，重新查找等待遍历的访问（不计入 TLB 统计）
+void Mmu::replay() {
+    for (Access& acc : accesses) {
+        uint32_t shift = 0;
+        if (!acc.translated && tlbs[0].lookup(acc.vaddr, acc.paddr, shift)) {
+            acc.translated = true;
+            acc.issue = cycle;
+        }
+    }
+}
+
+// 遍历器的页表项读优先；否则发出最早的已翻译、且同一页中没有更早的访问在等待的访问
+void Mmu::issue() {
+    if (cache_full.read()) {
+        return;
+    }
+    if (walking && !walk.waiting) {
+        walk.id = allocate_id();
+        walk.waiting = true;
+        pte_reads++;
+        send(false, walk.table + pt_index(walk.vaddr, walk.level) * PTE_SIZE, 0, 0, walk.id);
+        return;
+    }
+
+    for (auto it = accesses.begin(); it != accesses.end(); ++it) {
+        if (!it->translated || it->issue > cycle) {
+            continue;
+        }
+        bool blocked = false;
+        for (auto older = accesses.begin(); older != it; ++older) {
+            if (older->vaddr >> PAGE_SHIFTS[0] == it->vaddr >> PAGE_SHIFTS[0]) {
+                blocked = true;
+                break;
+            }
+        }
+        if (blocked) {
+            continue;
+        }
+
+        uint32_t id = allocate_id();
+        inflight[id] = it->id;
+        translations++;
+        translation_cycles += cycle - it->start;
+        send(it->write, it->paddr, it->data, it->pc, id);
+        accesses.erase(it);
+        return;
+    }
+}
+
+void Mmu::send(bool is_write, uint32_t addr, uint32_t data, uint32_t pc_value, uint32_t id) {
+    cache_address.write(addr);
+    cache_w_data.write(data);
+    cache_req_id.write(id);
+    cache_pc.write(pc_value);
+    cache_read.write(!is_write);
+    cache_write.write(is_write);
+}
+
+void Mmu::respond() {
+    if (responses.empty()) {
+        return;
+    }
+    r_data.write(responses.front().second);
+    resp_id.write(responses.front().first);
+    ready.write(true);
+    responses.pop_front();
+}
+
+// 缓存侧编号跳过 0，回绕时跳过仍在使用的编号
+uint32_t Mmu::allocate_id() {
+    while (next_id == 0 || inflight.count(next_id) || (walking && walk.waiting && walk.id == next_id)) {
+        next_id++;
+    }
+    return next_id++;
+}
+
+void Mmu::print_stats(std::ostream& os) const {
+    os << std::dec << "MMU: translations " << translations << ", avg translation latency "
+       << (translations ? (double)translation_cycles / translations : 0.0) << " cycles" << std::endl;
+    for (int i = 0; i < 2; i++) {
+        if (!tlbs[i].enabled()) {
+            continue;
+        }
+        uint64_t misses = tlb_lookups[i] - tlb_hits[i];
+        os << "  L" << i + 1 << " TLB (" << tlbs[i].entries() << " entries): hits " << tlb_hits[i] << ", misses "
+           << misses << ", hit rate " << (tlb_lookups[i] ? 100.0 * tlb_hits[i] / tlb_lookups[i] : 0.0)
+           << "%, reach " << tlbs[i].reach() / 1024 << " KiB" << std::endl;
+    }
+    os << "  Page walks: " << walks << ", avg " << (walks ? (double)walk_cycles / walks : 0.0) << " cycles, "
+       << (walks ? (double)pte_reads / walks : 0.0) << " PTE reads per walk, page faults " << page_faults << std::endl;
+    os << "  Pages walked: 4K " << walked_pages[0] << ", 2M " << walked_pages[1] << ", 1G " << walked_pages[2];
+    if (walk_cache.enabled()) {
+        os << ", walk cache hits " << walk_cache_hits[0] << " (level 2) " << walk_cache_hits[1] << " (level 3)";
+    }
+    os << std::endl;
+}
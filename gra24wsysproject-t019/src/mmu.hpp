@@ -0,0 +1,130 @@
+#ifndef MMU_HPP
+#define MMU_HPP
+
+#include <systemc.h>
+#include <deque>
+#include <iostream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cache_config.hpp"
+#include "page_table.hpp"
+#include "tlb.hpp"
+
+// 虚拟内存前端：接在请求方和 Cache 之间，把虚拟地址翻译成物理地址再交给缓存。
+// 请求方一侧的信号和协议与 Cache 相同（请求保持一个周期，ready 拉高一个周期，resp_id 标明完成的请求）。
+// 先查 L1 TLB，未命中再查 L2 TLB，都未命中时交给硬件页表遍历器：遍历器从根开始逐级读
+// 页表项（page_table.hpp 的三级页表），页表项的读和普通访存一样经过缓存层次结构，
+// 与请求方的访问争用缓存端口（遍历器优先）。配置了页表遍历缓存时，先查中间级页表项的缓存，
+// 命中时跳过上面几级。只有一个遍历器，TLB 未命中按先后排队，同一页的未命中合并到一次遍历上。
+// 遍历完成后填入两级 TLB，等待这一页（或覆盖它的大页）的访问随即发出。
+// TLB 命中的访问可以越过等待遍历的访问先发出，但不越过同一 4 KiB 页中更早的访问。
+// L1 TLB 命中时请求晚 latency 个周期到达缓存；缓存的响应经 Mmu 转发，再晚一个周期返回。
+// 页表项不存在（缺页）时打印地址，等待这一页的访问不访问缓存，直接以数据 0 完成。
+// 遍历器不设置页表项的访问位和脏位，也不检查写权限
+class Mmu : public sc_module {
+public:
+    static const uint32_t MAX_PENDING = 16;  // 等待翻译或等待发出的访问数
+
+    // 请求方一侧
+    sc_in<bool> clk;          // 时钟信号
+    sc_in<bool> read;         // 读操作信号
+    sc_in<bool> write;        // 写操作信号
+    sc_in<uint32_t> address;  // 虚拟地址
+    sc_in<uint32_t> w_data;   // 写入数据信号
+    sc_in<uint32_t> req_id;   // 请求编号
+    sc_in<uint32_t> pc;       // 访存指令的 PC，转发给缓存
+    sc_out<uint32_t> r_data;  // 读出数据信号
+    sc_out<uint32_t> resp_id; // 完成的请求编号
+    sc_out<bool> ready;       // 操作完成信号
+    sc_out<bool> full;        // 等待的访问已满，请求方暂停发送
+
+    // 连接到 Cache 请求方端口的信号
+    sc_out<bool> cache_read;
+    sc_out<bool> cache_write;
+    sc_out<uint32_t> cache_address;  // 物理地址
+    sc_out<uint32_t> cache_w_data;
+    sc_out<uint32_t> cache_req_id;   // Mmu 自己分配的编号
+    sc_out<uint32_t> cache_pc;
+    sc_in<uint32_t> cache_r_data;
+    sc_in<uint32_t> cache_resp_id;
+    sc_in<bool> cache_ready;
+    sc_in<bool> cache_full;
+
+    SC_HAS_PROCESS(Mmu);
+
+    // config 须已通过 CacheConfig::validate 检查
+    Mmu(sc_module_name name, const CacheConfig& config = CacheConfig());
+
+    // 设置根页表的物理地址（相当于写 CR3），清空 TLB 和页表遍历缓存
+    void set_root(uint32_t root);
+
+    // 打印 TLB 命中率、TLB 覆盖的范围、页表遍历次数和平均延迟
+    void print_stats(std::ostream& os) const;
+
+private:
+    // 请求方的一次访问
+    struct Access {
+        bool write;
+        uint32_t vaddr;
+        uint32_t data;
+        uint32_t id;
+        uint32_t pc;
+        uint64_t start;    // 到达的周期
+        bool translated;
+        uint32_t paddr;
+        uint64_t issue;    // 翻译完成、最早可以发给缓存的周期
+    };
+
+    // 正在进行的页表遍历
+    struct Walk {
+        uint32_t vaddr;    // 触发遍历的虚拟地址
+        uint32_t level;    // 正在读的页表级别
+        uint32_t table;    // 这一级页表的物理地址
+        uint64_t start;
+        bool waiting;      // 页表项的读已发出，等待缓存返回
+        uint32_t id;       // 页表项读的缓存侧编号
+    };
+
+    std::vector<Tlb> tlbs;         // L1 / L2 TLB，L2 可以不启用
+    uint32_t latencies[2];         // 两级 TLB 的查找延迟
+    Tlb walk_cache;                // 中间级页表项的缓存，全相联
+    uint32_t root_table = 0;
+    uint64_t cycle = 0;            // 当前时钟周期
+    uint32_t next_id = 1;          // 下一个缓存侧编号
+
+    std::deque<Access> accesses;   // 按到达顺序
+    std::deque<uint32_t> walk_queue;  // 等待遍历的 4 KiB 虚拟页号
+    Walk walk;
+    bool walking = false;
+    std::unordered_map<uint32_t, uint32_t> inflight;  // 已发给缓存的访问：缓存侧编号 -> 请求方编号
+    std::deque<std::pair<uint32_t, uint32_t> > responses;  // 等待返回的（请求方编号, 数据）
+
+    // 统计
+    uint64_t tlb_lookups[2] = {0, 0};
+    uint64_t tlb_hits[2] = {0, 0};
+    uint64_t translations = 0;
+    uint64_t translation_cycles = 0;  // 到达到发给缓存的周期数之和
+    uint64_t walks = 0;
+    uint64_t walk_cycles = 0;
+    uint64_t pte_reads = 0;
+    uint64_t walk_cache_hits[2] = {0, 0};  // 命中第 2 级 / 第 3 级页表项，跳过两次 / 一次读
+    uint64_t walked_pages[PAGE_SIZE_KINDS] = {0, 0, 0};
+    uint64_t page_faults = 0;
+
+    void process_mmu();
+    void receive_cache();
+    void accept(const Access& req);
+    void start_walk();
+    void step_walk(uint32_t pte);
+    void fault();
+    void replay();
+    void issue();
+    void send(bool is_write, uint32_t addr, uint32_t data, uint32_t pc_value, uint32_t id);
+    void respond();
+    uint32_t allocate_id();
+    bool queued(uint32_t vpn) const;
+};
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef MSHR_HPP
+#define MSHR_HPP
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "mem_line.hpp"
+
+// 合并到一条缺失上的访问，数据就绪后按到达顺序完成
+struct MissTarget {
+    uint32_t id;     // 请求编号
+    bool write;
+    uint32_t addr;
+    uint32_t data;   // 写入的数据
+    uint64_t start;  // 请求到达的周期
+    uint32_t pc;     // 访存指令的 PC，供预取器使用
+    bool posted;     // 存储缓冲排空的写，不向请求方响应
+};
+
+// 一条未完成的缺失，按缓存行记录。由 source 级提供数据，填入 top 到 source 之间
+// 的各级，占用这些级别各一个 MSHR。需求缺失的 top 为 0；预取填到预取器所在的级别，
+// 没有合并进来的访问
+struct Miss {
+    uint32_t line_addr;  // 缓存行地址
+    uint32_t top;        // 填充的最上一级
+    uint32_t source;     // 提供数据的级别，等于级数时表示主存
+    bool prefetch;       // 由预取器发出
+    uint32_t mem_id;     // 向主存取数据的请求编号，由下级缓存提供数据时为 0
+    uint64_t done;       // 数据就绪的周期
+    bool arrived;        // 数据是否已取回
+    bool refetch;        // 取数请求发出后又有写操作发往同一区域，返回的数据已过时
+    bool exclusive;      // 为写取数据（一致性总线上的 GetM）
+    bool shared;         // 取回的行在其他核中也有副本
+    MemLine line;        // 取回的缓存行
+    std::vector<MissTarget> targets;
+};
+
+// 缺失状态保持寄存器（MSHR）：每级数量单独配置。访问已有缺失的缓存行时
+// 合并为次级缺失，不再向下一级发请求；某一级用完时缓存暂停接收请求
+class MshrFile {
+public:
+    MshrFile(const std::vector<uint32_t>& counts) : counts(counts), used(counts.size(), 0) {}
+
+    // 查找缓存行上未完成的缺失，没有时返回 nullptr
+    Miss* find(uint32_t line_addr) {
+        for (Miss& miss : misses) {
+            if (miss.line_addr == line_addr) {
+                return &miss;
+            }
+        }
+        return nullptr;
+    }
+
+    // 填充 top 到 source 之间各级的缺失是否还有空闲的 MSHR
+    bool can_allocate(uint32_t top, uint32_t source) const {
+        for (uint32_t level = top; level < source && level < counts.size(); level++) {
+            if (used[level] >= counts[level]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 预取不用每级的最后一个 MSHR，留给需求缺失
+    bool can_allocate_prefetch(uint32_t top, uint32_t source) const {
+        for (uint32_t level = top; level < source && level < counts.size(); level++) {
+            if (used[level] + 1 >= counts[level]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 需求缺失
+    Miss& allocate(uint32_t line_addr, uint32_t source, const MissTarget& target) {
+        Miss& miss = reserve(line_addr, 0, source);
+        miss.targets.push_back(target);
+        primary++;
+        return miss;
+    }
+
+    // 预取到 top 级
+    Miss& allocate_prefetch(uint32_t line_addr, uint32_t top, uint32_t source) {
+        Miss& miss = reserve(line_addr, top, source);
+        miss.prefetch = true;
+        prefetches++;
+        return miss;
+    }
+
+    // 需求访问合并到只填下级的预取上：改为一直填到 L1，需要再占用上面各级的 MSHR。
+    // 上面某一级已用完时返回 false
+    bool promote(Miss& miss) {
+        if (!can_allocate(0, miss.top)) {
+            return false;
+        }
+        for (uint32_t level = 0; level < miss.top; level++) {
+            used[level]++;
+        }
+        miss.top = 0;
+        return true;
+    }
+
+    void merge(Miss& miss, const MissTarget& target) {
+        miss.targets.push_back(target);
+        secondary++;
+    }
+
+    // 缺失完成，释放它占用的 MSHR
+    void release(size_t index) {
+        for (uint32_t level = misses[index].top; level < misses[index].source && level < counts.size(); level++) {
+            used[level]--;
+        }
+        misses.erase(misses.begin() + index);
+    }
+
+    size_t size() const { return misses.size(); }
+    Miss& operator[](size_t index) { return misses[index]; }
+
+    // 任一级的 MSHR 全部占用
+    bool any_full() const {
+        for (size_t level = 0; level < counts.size(); level++) {
+            if (used[level] >= counts[level]) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 每周期调用一次，统计同时未完成的缺失数和 MSHR 用完的周期数
+    void sample() {
+        if (misses.size() > max_outstanding) {
+            max_outstanding = misses.size();
+        }
+        if (any_full()) {
+            full_cycles++;
+        }
+    }
+
+    void print_stats(std::ostream& os) const {
+        os << std::dec
+           << "MSHR primary misses: " << primary << ", secondary misses: " << secondary << std::endl
+           << "MSHR max outstanding: " << max_outstanding << ", full cycles: " << full_cycles << std::endl;
+        if (prefetches) {
+            os << "MSHR prefetches: " << prefetches << std::endl;
+        }
+    }
+
+private:
+    Miss& reserve(uint32_t line_addr, uint32_t top, uint32_t source) {
+        for (uint32_t level = top; level < source && level < counts.size(); level++) {
+            used[level]++;
+        }
+        Miss miss;
+        miss.line_addr = line_addr;
+        miss.top = top;
+        miss.source = source;
+        miss.prefetch = false;
+        miss.mem_id = 0;
+        miss.done = 0;
+        miss.arrived = false;
+        miss.refetch = false;
+        miss.exclusive = false;
+        miss.shared = false;
+        misses.push_back(miss);
+        return misses.back();
+    }
+
+    std::vector<uint32_t> counts;  // 每级 MSHR 数量
+    std::vector<uint32_t> used;    // 每级已占用的数量
+    std::vector<Miss> misses;
+
+    // 统计
+    uint64_t primary = 0;
+    uint64_t secondary = 0;
+    uint64_t prefetches = 0;
+    size_t max_outstanding = 0;
+    uint64_t full_cycles = 0;
+};
+
+#endif
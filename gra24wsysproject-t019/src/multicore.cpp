@@ -0,0 +1,227 @@
+#include <systemc.h>
+#include <vector>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "cache.hpp"
+#include "memory.hpp"
+#include "snoop_bus.hpp"
+
+// 一个核的请求方信号
+struct CoreSignals {
+    sc_signal<bool> read, write, ready, full;
+    sc_signal<uint32_t> address, w_data, req_id, pc, r_data, resp_id;
+};
+
+// 核按顺序执行的一条访存
+struct Access {
+    bool write;
+    uint32_t addr;
+    uint32_t data;
+};
+
+// 主程序：多个核各有私有缓存，经一致性总线共享最后一级缓存和主存
+int sc_main(int argc, char** argv) {
+    sc_clock clk_signal("clk_signal", 10, SC_NS);
+
+    // 命令行参数与 stufecache 相同：配置文件名或 key=value（例如 cores=4、protocol=moesi、
+    // bus_latency=3、coherence=directory、directory_entries=256...），默认两个核，私有 L1 加共享 L2
+    CacheConfig config;
+    config.cores = 2;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool ok = arg.find('=') != std::string::npos ? config.parse_option(arg) : config.load(arg);
+        if (!ok) {
+            return 1;
+        }
+    }
+    if (config.cores < 2) {
+        std::cerr << "multicore needs at least 2 cores" << std::endl;
+        return 1;
+    }
+    if (!config.validate()) {
+        return 1;
+    }
+    if (config.vm) {
+        std::cerr << "multicore uses physical addresses, use stufecache for vm=true" << std::endl;
+        return 1;
+    }
+    config.print(std::cout);
+
+    // 实例化各核的私有缓存、总线和主存
+    uint32_t cores = config.cores;
+    std::vector<std::unique_ptr<CoreSignals> > signals;
+    std::vector<std::unique_ptr<Cache> > caches;
+    SnoopBus bus("Bus", config);
+    Memory memory("Memory");
+    for (uint32_t core = 0; core < cores; core++) {
+        signals.emplace_back(new CoreSignals);
+        caches.emplace_back(new Cache(("Core" + std::to_string(core)).c_str(), config.private_config()));
+
+        CoreSignals& s = *signals[core];
+        Cache& cache = *caches[core];
+        cache.clk(clk_signal);
+        cache.read(s.read);
+        cache.write(s.write);
+        cache.address(s.address);
+        cache.w_data(s.w_data);
+        cache.req_id(s.req_id);
+        cache.pc(s.pc);
+        cache.r_data(s.r_data);
+        cache.resp_id(s.resp_id);
+        cache.ready(s.ready);
+        cache.full(s.full);
+        bus.connect(cache, core);
+    }
+
+    // 总线与主存之间的信号
+    sc_signal<bool> mem_w_signal, mem_r_signal, mem_ready_signal, mem_full_signal;
+    sc_signal<uint32_t> mem_wdata, mem_addr, mem_rdata, mem_req_id, mem_resp_id, mem_burst_len;
+    sc_signal<MemLine> mem_wline, mem_rline;
+
+    bus.clk(clk_signal);
+    bus.mem_read(mem_r_signal);
+    bus.mem_write(mem_w_signal);
+    bus.mem_address(mem_addr);
+    bus.mem_w_data(mem_wdata);
+    bus.mem_req_id(mem_req_id);
+    bus.mem_ready(mem_ready_signal);
+    bus.mem_full(mem_full_signal);
+    bus.mem_r_data(mem_rdata);
+    bus.mem_resp_id(mem_resp_id);
+    bus.mem_burst_len(mem_burst_len);
+    bus.mem_w_line(mem_wline);
+    bus.mem_r_line(mem_rline);
+
+    memory.clk(clk_signal);
+    memory.read(mem_r_signal);
+    memory.write(mem_w_signal);
+    memory.address(mem_addr);
+    memory.w_data(mem_wdata);
+    memory.req_id(mem_req_id);
+    memory.burst_len(mem_burst_len);
+    memory.w_line(mem_wline);
+    memory.r_data(mem_rdata);
+    memory.r_line(mem_rline);
+    memory.resp_id(mem_resp_id);
+    memory.ready(mem_ready_signal);
+    memory.full(mem_full_signal);
+
+    // 各核同时执行自己的访存序列，每条等上一条完成后再发出，返回总周期数。
+    // 读到的数据按核记在 last_read 中
+    std::vector<uint32_t> last_read(cores, 0);
+    auto run = [&](const std::vector<std::vector<Access> >& programs) {
+        std::vector<size_t> next(cores, 0);
+        std::vector<bool> waiting(cores, false);
+        int cycles = 0;
+        while (true) {
+            bool finished = true;
+            for (uint32_t core = 0; core < cores; core++) {
+                if (waiting[core] || next[core] < programs[core].size()) {
+                    finished = false;
+                }
+                if (waiting[core] || next[core] >= programs[core].size() || signals[core]->full.read()) {
+                    continue;
+                }
+                const Access& access = programs[core][next[core]++];
+                signals[core]->address.write(access.addr);
+                signals[core]->w_data.write(access.data);
+                signals[core]->write.write(access.write);
+                signals[core]->read.write(!access.write);
+                waiting[core] = true;
+            }
+            if (finished) {
+                return cycles;
+            }
+            sc_start(10, SC_NS);
+            cycles++;
+            for (uint32_t core = 0; core < cores; core++) {
+                signals[core]->read.write(false);
+                signals[core]->write.write(false);
+                if (signals[core]->ready.read()) {
+                    last_read[core] = signals[core]->r_data.read();
+                    waiting[core] = false;
+                }
+            }
+        }
+    };
+
+    // 只让一个核执行一条访存，其余核空闲
+    auto single = [&](uint32_t core, bool write, uint32_t addr, uint32_t data) {
+        std::vector<std::vector<Access> > programs(cores);
+        programs[core].push_back(Access{write, addr, data});
+        int cycles = run(programs);
+        std::cout << "Core " << std::dec << core << (write ? " wrote " : " read ") << std::hex
+                  << (write ? data : last_read[core]) << (write ? " to " : " from ") << addr << " in " << std::dec
+                  << cycles << " cycles" << std::endl;
+    };
+
+    // 测试用例 1: 核 0 写入后核 1 读（核 0 的脏行直接传给核 1，两者都变为共享），
+    // 核 1 再写（升级，核 0 的副本失效），核 0 再读（从核 1 取得新值）
+    std::cout << "[TEST 1] Core 0 writes 0x00001000, core 1 reads and writes it, core 0 reads it back" << std::endl;
+    single(0, true, 0x00001000, 0x11111111);
+    single(1, false, 0x00001000, 0);
+    single(1, true, 0x00001000, 0x22222222);
+    single(0, false, 0x00001000, 0);
+
+    // 测试用例 2: 两个核各自反复读改写自己的计数器。计数器在同一缓存行时（伪共享）
+    // 每次写都要从另一个核抢回这一行；相隔一行后都在各自的 L1 中命中
+    std::cout << "[TEST 2] False sharing: cores 0 and 1 update 0x00002000 / 0x00002004, then 0x00003000 / 0x00003040"
+              << std::endl;
+    for (uint32_t stride : {4u, 64u}) {
+        uint32_t base = stride == 4 ? 0x00002000 : 0x00003000;
+        std::vector<std::vector<Access> > programs(cores);
+        for (uint32_t core = 0; core < 2; core++) {
+            for (uint32_t i = 1; i <= 50; i++) {
+                programs[core].push_back(Access{false, base + core * stride, 0});
+                programs[core].push_back(Access{true, base + core * stride, i});
+            }
+        }
+        int cycles = run(programs);
+        std::cout << "Counters " << std::dec << stride << " bytes apart: 100 updates took " << cycles << " cycles"
+                  << std::endl;
+    }
+    single(0, false, 0x00002000, 0);
+    single(1, false, 0x00002004, 0);
+
+    // 测试用例 3: 所有核轮流写同一个锁变量（先读再写），锁所在的行在各核之间来回传递
+    std::cout << "[TEST 3] Lock ping-pong: every core reads and writes 0x00004000 in turn, 10 rounds" << std::endl;
+    int lock_cycles = 0;
+    for (uint32_t round = 0; round < 10; round++) {
+        for (uint32_t core = 0; core < cores; core++) {
+            std::vector<std::vector<Access> > programs(cores);
+            programs[core].push_back(Access{false, 0x00004000, 0});
+            programs[core].push_back(Access{true, 0x00004000, core + 1});
+            lock_cycles += run(programs);
+        }
+    }
+    std::cout << "Lock handed over " << std::dec << 10 * cores << " times in " << lock_cycles << " cycles" << std::endl;
+    single(0, false, 0x00004000, 0);
+
+    // 测试用例 4: 每个核读两遍自己的 12 行（放得进 L1）。第二遍本应全部命中；
+    // 目录模式下目录放不下所有核的行时，被替换的目录项使对应的副本失效，第二遍又要缺失
+    std::cout << "[TEST 4] Private working sets: every core reads 12 lines of its own region twice" << std::endl;
+    for (int pass = 1; pass <= 2; pass++) {
+        std::vector<std::vector<Access> > programs(cores);
+        for (uint32_t core = 0; core < cores; core++) {
+            for (uint32_t i = 0; i < 12; i++) {
+                programs[core].push_back(Access{false, 0x00100000 + core * 0x1000 + i * 64, 0});
+            }
+        }
+        int cycles = run(programs);
+        std::cout << "Pass " << pass << ": " << std::dec << 12 * cores << " reads took " << cycles << " cycles"
+                  << std::endl;
+    }
+
+    // 结束仿真
+    for (uint32_t core = 0; core < cores; core++) {
+        std::cout << "Core " << core << ":" << std::endl;
+        caches[core]->print_stats(std::cout);
+    }
+    bus.print_stats(std::cout);
+    memory.print_stats(std::cout);
+    std::cout << "Simulation ends" << std::endl;
+
+    return 0;
+}
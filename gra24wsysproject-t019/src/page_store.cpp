@@ -0,0 +1,199 @@
+#include "page_store.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include <elf.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+PageStore::PageStore() {}
+
+PageStore::~PageStore() {
+    for (size_t i = 0; i < mappings.size(); i++) {
+        munmap(mappings[i].base, mappings[i].length);
+    }
+}
+
+// 页表项，二级页表按需分配
+uint8_t*& PageStore::page_slot(uint32_t addr) {
+    std::unique_ptr<PageTable>& table = directory[addr >> (PAGE_BITS + TABLE_BITS)];
+    if (!table) {
+        table.reset(new PageTable());
+        table->fill(nullptr);
+    }
+    return (*table)[(addr >> PAGE_BITS) & (TABLE_SIZE - 1)];
+}
+
+// 查找页面，不分配
+uint8_t* PageStore::find_page(uint32_t addr) const {
+    const PageTable* table = directory[addr >> (PAGE_BITS + TABLE_BITS)].get();
+    if (!table) {
+        return nullptr;
+    }
+    return (*table)[(addr >> PAGE_BITS) & (TABLE_SIZE - 1)];
+}
+
+// 查找页面，不存在时分配一个全零页面
+uint8_t* PageStore::touch_page(uint32_t addr) {
+    uint8_t*& page = page_slot(addr);
+    if (!page) {
+        owned_pages.emplace_back(new uint8_t[PAGE_SIZE]());
+        page = owned_pages.back().get();
+    }
+    return page;
+}
+
+bool PageStore::load_image(const std::string& path, uint32_t base) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Cannot open memory image: " << path << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        std::cerr << "Cannot stat memory image: " << path << std::endl;
+        close(fd);
+        return false;
+    }
+    size_t size = st.st_size;
+    if (size == 0) {
+        close(fd);
+        return true; // 空镜像：内存保持全零
+    }
+
+    // MAP_PRIVATE：仿真中的写操作只修改私有副本，不会写回文件
+    void* image = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED) {
+        std::cerr << "Cannot map memory image: " << path << std::endl;
+        return false;
+    }
+    mappings.push_back({image, size});
+
+    uint8_t* bytes = static_cast<uint8_t*>(image);
+    if (size >= SELFMAG && std::memcmp(bytes, ELFMAG, SELFMAG) == 0) {
+        return install_elf(bytes, size, path);
+    }
+    if (base + (uint64_t)size > (1ull << 32)) {
+        std::cerr << "Memory image does not fit into the 32-bit address space: " << path << std::endl;
+        return false;
+    }
+    install(base, bytes, size);
+    return true;
+}
+
+void PageStore::install(uint32_t addr, uint8_t* src, uint64_t len) {
+    while (len > 0) {
+        uint32_t offset = addr & (PAGE_SIZE - 1);
+        uint32_t chunk = (uint32_t)std::min<uint64_t>(len, PAGE_SIZE - offset);
+        uint8_t*& page = page_slot(addr);
+        if (!page && chunk == PAGE_SIZE) {
+            page = src; // 零拷贝：页面直接指向映射
+            mapped_pages++;
+        } else {
+            std::memcpy(touch_page(addr) + offset, src, chunk); // 不完整或已存在的页面
+        }
+        addr += chunk;
+        src += chunk;
+        len -= chunk;
+    }
+}
+
+// 收集需要加载的段：只放置文件中的部分（p_filesz），bss 部分本来就读为 0
+template <typename Ehdr, typename Phdr>
+static bool collect_segments(const uint8_t* image, size_t size, std::vector<Phdr>& segments) {
+    const Ehdr* ehdr = reinterpret_cast<const Ehdr*>(image);
+    if (size < sizeof(Ehdr) || ehdr->e_phentsize != sizeof(Phdr) ||
+        ehdr->e_phoff + (uint64_t)ehdr->e_phnum * sizeof(Phdr) > size) {
+        return false;
+    }
+    for (int i = 0; i < ehdr->e_phnum; i++) {
+        Phdr phdr;
+        std::memcpy(&phdr, image + ehdr->e_phoff + i * sizeof(Phdr), sizeof(Phdr));
+        if (phdr.p_type != PT_LOAD || phdr.p_filesz == 0) {
+            continue;
+        }
+        if (phdr.p_offset + phdr.p_filesz > size ||
+            phdr.p_paddr + phdr.p_filesz > (1ull << 32)) {
+            return false;
+        }
+        segments.push_back(phdr);
+    }
+    return true;
+}
+
+bool PageStore::install_elf(uint8_t* image, size_t size, const std::string& path) {
+    if (size < EI_NIDENT || image[EI_DATA] != ELFDATA2LSB) {
+        std::cerr << "Unsupported ELF image (only little-endian): " << path << std::endl;
+        return false;
+    }
+
+    bool ok = false;
+    if (image[EI_CLASS] == ELFCLASS32) {
+        std::vector<Elf32_Phdr> segments;
+        ok = collect_segments<Elf32_Ehdr>(image, size, segments);
+        for (size_t i = 0; ok && i < segments.size(); i++) {
+            install(segments[i].p_paddr, image + segments[i].p_offset, segments[i].p_filesz);
+        }
+    } else if (image[EI_CLASS] == ELFCLASS64) {
+        std::vector<Elf64_Phdr> segments;
+        ok = collect_segments<Elf64_Ehdr>(image, size, segments);
+        for (size_t i = 0; ok && i < segments.size(); i++) {
+            install(segments[i].p_paddr, image + segments[i].p_offset, segments[i].p_filesz);
+        }
+    }
+    if (!ok) {
+        std::cerr << "Malformed ELF image: " << path << std::endl;
+    }
+    return ok;
+}
+
+void PageStore::read(uint32_t addr, uint8_t* dst, uint32_t len) const {
+    while (len > 0) {
+        uint32_t offset = addr & (PAGE_SIZE - 1);
+        uint32_t chunk = std::min(len, PAGE_SIZE - offset);
+        const uint8_t* page = find_page(addr);
+        if (page) {
+            std::memcpy(dst, page + offset, chunk);
+        } else {
+            std::memset(dst, 0, chunk); // 未触及的页面读为 0
+        }
+        addr += chunk;
+        dst += chunk;
+        len -= chunk;
+    }
+}
+
+void PageStore::write(uint32_t addr, const uint8_t* src, uint32_t len) {
+    while (len > 0) {
+        uint32_t offset = addr & (PAGE_SIZE - 1);
+        uint32_t chunk = std::min(len, PAGE_SIZE - offset);
+        std::memcpy(touch_page(addr) + offset, src, chunk);
+        addr += chunk;
+        src += chunk;
+        len -= chunk;
+    }
+}
+
+uint32_t PageStore::read_word(uint32_t addr) const {
+    uint8_t bytes[4];
+    read(addr, bytes, 4);
+    uint32_t data = 0;
+    for (int i = 3; i >= 0; i--) {
+        data = (data << 8) | bytes[i];
+    }
+    return data;
+}
+
+void PageStore::write_word(uint32_t addr, uint32_t data) {
+    uint8_t bytes[4];
+    for (int i = 0; i < 4; i++) {
+        bytes[i] = data & 0xFF;
+        data >>= 8;
+    }
+    write(addr, bytes, 4);
+}
@@ -0,0 +1,64 @@
+#ifndef PAGE_STORE_HPP
+#define PAGE_STORE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 稀疏分页存储：二级页表，页面在第一次写入时才分配，
+// 未分配的页面读出为 0。页面也可以直接指向以写时复制方式
+// 映射的镜像文件，加载时不拷贝数据
+class PageStore {
+public:
+    static const uint32_t PAGE_BITS = 12;                 // 每页 4 KiB
+    static const uint32_t PAGE_SIZE = 1u << PAGE_BITS;
+    static const uint32_t TABLE_BITS = 10;                // 每级页表 1024 项
+    static const uint32_t TABLE_SIZE = 1u << TABLE_BITS;
+
+    PageStore();
+    ~PageStore();
+
+    // 加载内存镜像：ELF 文件按 PT_LOAD 段的物理地址放置，
+    // 其他文件按原始二进制放在 base 处。失败时返回 false
+    bool load_image(const std::string& path, uint32_t base);
+
+    // 按字节读写，可跨页
+    void read(uint32_t addr, uint8_t* dst, uint32_t len) const;
+    void write(uint32_t addr, const uint8_t* src, uint32_t len);
+
+    // 小端 32 位字读写
+    uint32_t read_word(uint32_t addr) const;
+    void write_word(uint32_t addr, uint32_t data);
+
+    size_t resident_pages() const { return owned_pages.size() + mapped_pages; }
+
+private:
+    typedef std::array<uint8_t*, TABLE_SIZE> PageTable;
+
+    // 一段写时复制的文件映射
+    struct Mapping {
+        void* base;
+        size_t length;
+    };
+
+    PageStore(const PageStore&) = delete;
+    PageStore& operator=(const PageStore&) = delete;
+
+    uint8_t* find_page(uint32_t addr) const;  // 未分配时返回 nullptr
+    uint8_t* touch_page(uint32_t addr);       // 按需分配并清零
+    uint8_t*& page_slot(uint32_t addr);       // 页表项，必要时分配二级页表
+
+    // 把 [src, src + len) 放到 addr 处：完整且空闲的页面直接指向映射，其余拷贝
+    void install(uint32_t addr, uint8_t* src, uint64_t len);
+    bool install_elf(uint8_t* image, size_t size, const std::string& path);
+
+    std::array<std::unique_ptr<PageTable>, TABLE_SIZE> directory; // 一级页表
+    std::vector<std::unique_ptr<uint8_t[]> > owned_pages;          // 已分配的页面
+    std::vector<Mapping> mappings;                                 // 镜像文件映射
+    size_t mapped_pages = 0;                                       // 指向映射的页面数
+};
+
+#endif
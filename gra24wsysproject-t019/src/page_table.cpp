@@ -0,0 +1,79 @@
+#include "page_table.hpp"
+
+#include <iostream>
+
+PageTable::PageTable(Memory& memory, uint32_t table_base, uint32_t frame_base)
+    : memory(memory), next_table(table_base & PTE_ADDR_MASK), next_frame(frame_base) {
+    root_table = allocate_table();
+}
+
+// 页表页不会用完：三级页表最多 1 + 4 + 2048 页
+uint32_t PageTable::allocate_table() {
+    uint32_t table = next_table;
+    next_table += 1u << pt_shift(1);
+    tables++;
+    return table;
+}
+
+uint32_t PageTable::entry(uint32_t table, uint32_t index) const {
+    auto it = entries.find(table + index * PTE_SIZE);
+    return it == entries.end() ? 0 : it->second;
+}
+
+void PageTable::set_entry(uint32_t table, uint32_t index, uint32_t value) {
+    entries[table + index * PTE_SIZE] = value;
+    memory.init_word(table + index * PTE_SIZE, value);
+}
+
+bool PageTable::map(uint32_t vaddr, uint32_t size, uint32_t page_size) {
+    uint32_t leaf_level = 0;
+    for (uint32_t level = 1; level <= PT_LEVELS; level++) {
+        if (page_size == 1u << pt_shift(level)) {
+            leaf_level = level;
+        }
+    }
+    if (!leaf_level) {
+        std::cerr << "Page size must be 4K, 2M or 1G: " << std::dec << page_size << std::endl;
+        return false;
+    }
+
+    uint64_t begin = vaddr & ~(uint64_t)(page_size - 1);
+    uint64_t end = ((uint64_t)vaddr + size + page_size - 1) & ~(uint64_t)(page_size - 1);
+    for (uint64_t page = begin; page < end; page += page_size) {
+        uint64_t frame = (next_frame + page_size - 1) & ~(uint64_t)(page_size - 1);
+        if (frame + page_size > (1ull << 32)) {
+            std::cerr << "Out of physical memory mapping " << std::hex << page << std::endl;
+            return false;
+        }
+        if (!map_page(page, leaf_level, frame)) {
+            std::cerr << "Virtual address " << std::hex << page << " is already mapped" << std::endl;
+            return false;
+        }
+        next_frame = frame + page_size;
+        mapped += page_size;
+    }
+    return true;
+}
+
+// 从根逐级向下，缺少的中间页表按需分配；途中遇到大页或叶子项已存在时返回 false
+bool PageTable::map_page(uint32_t vaddr, uint32_t leaf_level, uint32_t frame) {
+    uint32_t table = root_table;
+    for (uint32_t level = PT_LEVELS; level > leaf_level; level--) {
+        uint32_t index = pt_index(vaddr, level);
+        uint32_t pte = entry(table, index);
+        if (!(pte & PTE_PRESENT)) {
+            pte = allocate_table() | PTE_PRESENT | PTE_WRITABLE;
+            set_entry(table, index, pte);
+        } else if (pte & PTE_LARGE) {
+            return false;
+        }
+        table = pte & PTE_ADDR_MASK;
+    }
+
+    uint32_t index = pt_index(vaddr, leaf_level);
+    if (entry(table, index) & PTE_PRESENT) {
+        return false;
+    }
+    set_entry(table, index, frame | PTE_PRESENT | PTE_WRITABLE | (leaf_level > 1 ? PTE_LARGE : 0));
+    return true;
+}
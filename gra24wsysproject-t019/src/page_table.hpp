@@ -0,0 +1,55 @@
+#ifndef PAGE_TABLE_HPP
+#define PAGE_TABLE_HPP
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "memory.hpp"
+
+// 存放在 Memory 中、由 Mmu 的页表遍历器读取的三级基数页表，格式与 x86 的 PAE 分页相同：
+// 32 位虚拟地址分为 2 + 9 + 9 位索引和 12 位页内偏移，页表项 8 字节（物理地址只有 32 位，
+// 高 32 位总是 0，遍历器只读低 32 位）。第 3 级（根，4 项）和第 2 级的项置 PTE_LARGE 时
+// 直接映射 1 GiB / 2 MiB 的大页，否则指向下一级页表；第 1 级的项映射 4 KiB 页
+const uint32_t PT_LEVELS = 3;
+const uint32_t PTE_SIZE = 8;
+const uint32_t PTE_PRESENT = 1u << 0;
+const uint32_t PTE_WRITABLE = 1u << 1;
+const uint32_t PTE_LARGE = 1u << 7;
+const uint32_t PTE_ADDR_MASK = 0xfffff000;
+
+// 第 level 级（1 ~ 3）页表项覆盖的虚拟地址位数，以及 vaddr 在这一级的索引
+inline uint32_t pt_shift(uint32_t level) { return 12 + 9 * (level - 1); }
+inline uint32_t pt_index(uint32_t vaddr, uint32_t level) { return (vaddr >> pt_shift(level)) & 0x1ff; }
+
+// 操作系统一侧：仿真开始前在 Memory 中建立页表（直接写入，不经过读写周期和缓存）。
+// 页表占用的页从 table_base 起顺序分配，映射的物理页从 frame_base 起按页大小对齐顺序分配
+class PageTable {
+public:
+    PageTable(Memory& memory, uint32_t table_base, uint32_t frame_base);
+
+    // 根页表的物理地址，交给 Mmu::set_root
+    uint32_t root() const { return root_table; }
+
+    // 用大小为 page_size（4K / 2M / 1G）的页映射 [vaddr, vaddr + size)，两端按页对齐扩展。
+    // 与已有的映射重叠或物理地址用完时打印原因并返回 false
+    bool map(uint32_t vaddr, uint32_t size, uint32_t page_size);
+
+    uint32_t table_pages() const { return tables; }
+    uint64_t mapped_bytes() const { return mapped; }
+
+private:
+    bool map_page(uint32_t vaddr, uint32_t leaf_level, uint32_t frame);
+    uint32_t allocate_table();
+    uint32_t entry(uint32_t table, uint32_t index) const;
+    void set_entry(uint32_t table, uint32_t index, uint32_t value);
+
+    Memory& memory;
+    uint32_t root_table;
+    uint64_t next_table;
+    uint64_t next_frame;
+    uint32_t tables = 0;
+    uint64_t mapped = 0;
+    std::unordered_map<uint32_t, uint32_t> entries;  // 已写入的页表项地址 -> 低 32 位
+};
+
+#endif
@@ -0,0 +1,159 @@
+#include "prefetcher.hpp"
+
+#include "cache_geometry.hpp"
+
+Prefetcher::Prefetcher(PrefetchKind kind, uint32_t degree, uint32_t line_size)
+    : kind(kind), degree(degree), line_size(line_size), line_shift(log2_exact(line_size)), line_mask(line_size - 1) {
+    if (kind == PREFETCH_STRIDE || kind == PREFETCH_PC_STRIDE) {
+        table.assign(TABLE_SIZE, StrideEntry{false, 0, 0, 0, 0});
+    } else if (kind == PREFETCH_STREAM) {
+        streams.assign(STREAMS, Stream{false, 0, 0, 0});
+    }
+    if (kind != PREFETCH_NONE) {
+        polluted.assign(FILTER_SIZE, 0);
+    }
+}
+
+void Prefetcher::access(uint32_t addr, uint32_t pc, bool hit, std::vector<uint32_t>& candidates) {
+    accesses++;
+    uint32_t line = addr & ~line_mask;
+
+    // 第一次命中预取来的行：预取有用，同时像缺失一样触发后续预取（tagged prefetch）
+    bool trigger = !hit;
+    if (hit && unused.erase(line)) {
+        useful++;
+        trigger = true;
+    }
+    if (!hit) {
+        misses++;
+        uint32_t& slot = polluted[(line >> line_shift) & (FILTER_SIZE - 1)];
+        if (slot == (line | 1)) {
+            pollution++;
+            slot = 0;
+        }
+    }
+
+    switch (kind) {
+    case PREFETCH_NEXT_LINE:
+        if (trigger) {
+            for (uint32_t i = 1; i <= degree; i++) {
+                push(addr, line + i * line_size, candidates);
+            }
+        }
+        break;
+    case PREFETCH_STRIDE:
+        train_stride(addr >> PAGE_SHIFT, addr, candidates);
+        break;
+    case PREFETCH_PC_STRIDE:
+        train_stride(pc, addr, candidates);
+        break;
+    case PREFETCH_STREAM:
+        train_stream(line, trigger, candidates);
+        break;
+    default:
+        break;
+    }
+}
+
+// 参考预测表：同一表项连续两次出现相同的非零跨步后开始预取
+void Prefetcher::train_stride(uint32_t key, uint32_t addr, std::vector<uint32_t>& candidates) {
+    StrideEntry& entry = table[key & (TABLE_SIZE - 1)];
+    if (!entry.valid || entry.tag != key) {
+        entry = StrideEntry{true, key, addr, 0, 0};
+        return;
+    }
+
+    int32_t stride = (int32_t)(addr - entry.last_addr);
+    entry.last_addr = addr;
+    if (stride == 0) {
+        return;
+    }
+    if (stride == entry.stride) {
+        entry.confidence = entry.confidence < 3 ? entry.confidence + 1 : 3;
+    } else {
+        entry.stride = stride;
+        entry.confidence = 0;
+    }
+    if (entry.confidence < 1) {
+        return;
+    }
+
+    // 跨步小于缓存行时按整行向前预取
+    int32_t step = stride;
+    if (step > -(int32_t)line_size && step < (int32_t)line_size) {
+        step = stride > 0 ? line_size : -(int32_t)line_size;
+    }
+    uint32_t last_line = addr & ~line_mask;
+    for (uint32_t i = 1; i <= degree; i++) {
+        uint32_t line = (addr + i * step) & ~line_mask;
+        if (line != last_line) {
+            push(addr, line, candidates);
+            last_line = line;
+        }
+    }
+}
+
+void Prefetcher::train_stream(uint32_t line, bool miss, std::vector<uint32_t>& candidates) {
+    Stream* stream = nullptr;
+    for (Stream& s : streams) {
+        if (s.valid && line >= s.head && line < s.next) {
+            stream = &s;
+            break;
+        }
+    }
+
+    if (!stream) {
+        if (!miss) {
+            return;
+        }
+        // 分配最久未用的流缓冲，从缺失行的下一条开始
+        stream = &streams[0];
+        for (Stream& s : streams) {
+            if (!s.valid || s.last_use < stream->last_use) {
+                stream = &s;
+                if (!s.valid) {
+                    break;
+                }
+            }
+        }
+        stream->valid = true;
+        stream->next = line + line_size;
+    }
+
+    // 窗口推进到访问行之后，补足 degree 条
+    stream->head = line + line_size;
+    stream->last_use = accesses;
+    while (stream->next < stream->head + degree * line_size) {
+        push(line, stream->next, candidates);
+        stream->next += line_size;
+    }
+}
+
+void Prefetcher::push(uint32_t addr, uint32_t line, std::vector<uint32_t>& candidates) {
+    if (line >> PAGE_SHIFT == addr >> PAGE_SHIFT) {
+        candidates.push_back(line);
+    }
+}
+
+void Prefetcher::filled(uint32_t line_addr, bool evicted, uint32_t victim) {
+    unused.insert(line_addr);
+    if (evicted) {
+        polluted[(victim >> line_shift) & (FILTER_SIZE - 1)] = victim | 1;
+    }
+}
+
+void Prefetcher::removed(uint32_t line_addr) {
+    if (unused.erase(line_addr)) {
+        useless++;
+    }
+}
+
+void Prefetcher::print_stats(std::ostream& os, uint32_t level) const {
+    uint64_t correct = useful + late_count;
+    os << std::dec << "L" << level + 1 << " prefetcher (" << prefetch_name(kind) << ", degree " << degree << "): issued "
+       << issued_count << ", useful " << useful << ", late " << late_count << ", useless " << useless
+       << ", pollution misses " << pollution << std::endl
+       << "  accuracy: " << (issued_count ? 100.0 * correct / issued_count : 0.0) << "%"
+       << ", coverage: " << (correct + misses ? 100.0 * correct / (correct + misses) : 0.0) << "%"
+       << ", timeliness: " << (correct ? 100.0 * useful / correct : 0.0) << "%" << std::endl;
+}
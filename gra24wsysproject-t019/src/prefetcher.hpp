@@ -0,0 +1,89 @@
+#ifndef PREFETCHER_HPP
+#define PREFETCHER_HPP
+
+#include <cstdint>
+#include <iostream>
+#include <unordered_set>
+#include <vector>
+
+#include "cache_config.hpp"
+
+// 一级缓存的硬件预取器。观察到达本级的需求访问，给出要预取到本级的缓存行地址；
+// 预取由 Cache 经过正常的缺失路径和 MSHR 发出。种类由 CacheLevelConfig::prefetch 选定：
+//   next_line  缺失或第一次用到预取来的行时，预取后面 degree 条缓存行
+//   stride     按 4 KiB 区域跟踪访问跨步（不需要 PC），跨步连续确认后预取 degree 步
+//   pc_stride  同上，但按访存指令的 PC 建表（参考预测表）
+//   stream     流缓冲：缺失时分配一个流，沿地址递增方向保持 degree 条行的预取窗口，
+//              需求访问进入窗口后窗口向前推进
+// 预取不跨越 4 KiB 页。统计准确率、覆盖率、及时性和污染
+class Prefetcher {
+public:
+    Prefetcher(PrefetchKind kind, uint32_t degree, uint32_t line_size);
+
+    bool enabled() const { return kind != PREFETCH_NONE; }
+
+    // 一次需求访问到达本级，hit 表示本级命中。要预取的缓存行地址追加到 candidates
+    void access(uint32_t addr, uint32_t pc, bool hit, std::vector<uint32_t>& candidates);
+
+    void issued() { issued_count++; }
+
+    // 需求访问合并到尚未完成的预取上：预测正确但太晚
+    void late() { late_count++; }
+
+    // 预取的缓存行已填入本级，替换出了 victim（evicted 为 false 时没有替换）
+    void filled(uint32_t line_addr, bool evicted, uint32_t victim);
+
+    // 缓存行离开本级（替换或失效）。还没用过的预取行计为无用
+    void removed(uint32_t line_addr);
+
+    void print_stats(std::ostream& os, uint32_t level) const;
+
+private:
+    // 访问路径上只用移位和掩码：页大小、跨步表和污染过滤器的项数都是 2 的幂
+    static const uint32_t PAGE_SHIFT = 12;     // 4 KiB
+    static const uint32_t TABLE_SIZE = 64;     // 跨步表项数
+    static const uint32_t STREAMS = 4;         // 流缓冲个数
+    static const uint32_t FILTER_SIZE = 256;   // 记录被预取替换出的行，用于统计污染
+    static_assert((TABLE_SIZE & (TABLE_SIZE - 1)) == 0 && (FILTER_SIZE & (FILTER_SIZE - 1)) == 0,
+                  "table sizes must be powers of two");
+
+    struct StrideEntry {
+        bool valid;
+        uint32_t tag;         // 区域号或 PC
+        uint32_t last_addr;
+        int32_t stride;
+        uint32_t confidence;  // 跨步连续重复的次数，饱和于 3
+    };
+
+    struct Stream {
+        bool valid;
+        uint32_t head;        // 下一条预计被访问的行
+        uint32_t next;        // 下一条要预取的行
+        uint64_t last_use;    // LRU 替换
+    };
+
+    void train_stride(uint32_t key, uint32_t addr, std::vector<uint32_t>& candidates);
+    void train_stream(uint32_t line, bool miss, std::vector<uint32_t>& candidates);
+    void push(uint32_t addr, uint32_t line, std::vector<uint32_t>& candidates);
+
+    PrefetchKind kind;
+    uint32_t degree;
+    uint32_t line_size;
+    uint32_t line_shift;  // log2(line_size)
+    uint32_t line_mask;   // line_size - 1
+    std::vector<StrideEntry> table;
+    std::vector<Stream> streams;
+    uint64_t accesses = 0;
+    std::unordered_set<uint32_t> unused;       // 已填入、还没被需求访问用到的预取行
+    std::vector<uint32_t> polluted;            // 被预取替换出的行（地址 | 1，0 为空）
+
+    // 统计
+    uint64_t issued_count = 0;
+    uint64_t useful = 0;       // 预取的行在替换前被需求访问命中
+    uint64_t late_count = 0;
+    uint64_t useless = 0;      // 预取的行没用过就被替换
+    uint64_t misses = 0;       // 本级的需求缺失
+    uint64_t pollution = 0;    // 需求缺失的行是被预取替换出去的
+};
+
+#endif
@@ -0,0 +1,251 @@
+#ifndef REPLACEMENT_HPP
+#define REPLACEMENT_HPP
+
+#include <cstdint>
+#include <vector>
+
+// 替换策略。各策略作为 CacheLevel 的模板参数在编译期选定，
+// 不使用虚函数，命中路径上的更新可以完全内联。统一接口：
+//   Policy(uint32_t sets, uint32_t ways, uint32_t seed);
+//   void on_hit(uint32_t set, uint32_t way);   // 命中
+//   void on_fill(uint32_t set, uint32_t way);  // 未命中后填入
+//   uint32_t victim(uint32_t set);             // 组内没有无效路时选出替换的路
+// 元数据按组紧凑存放（字节或位），不使用链表
+
+// LRU：每路一个字节的年龄，0 表示最近使用，ways - 1 表示最久未用
+class LruPolicy {
+public:
+    LruPolicy(uint32_t sets, uint32_t ways, uint32_t /*seed*/) : ways(ways), ages(sets * ways) {
+        for (uint32_t i = 0; i < sets * ways; i++) {
+            ages[i] = i % ways;
+        }
+    }
+
+    void on_hit(uint32_t set, uint32_t way) { touch(set, way); }
+    void on_fill(uint32_t set, uint32_t way) { touch(set, way); }
+
+    uint32_t victim(uint32_t set) {
+        const uint8_t* age = &ages[set * ways];
+        for (uint32_t way = 0; way < ways; way++) {
+            if (age[way] == ways - 1) {
+                return way;
+            }
+        }
+        return 0;
+    }
+
+private:
+    void touch(uint32_t set, uint32_t way) {
+        uint8_t* age = &ages[set * ways];
+        uint8_t old = age[way];
+        for (uint32_t w = 0; w < ways; w++) {
+            if (age[w] < old) {
+                age[w]++;
+            }
+        }
+        age[way] = 0;
+    }
+
+    uint32_t ways;
+    std::vector<uint8_t> ages;
+};
+
+// 树形伪 LRU：每组一棵二叉树（按 2 的幂补齐），每个内部节点一位，
+// 指向较久未用的一侧。路数不是 2 的幂时不会选中补齐出来的路
+class TreePlruPolicy {
+public:
+    TreePlruPolicy(uint32_t sets, uint32_t ways, uint32_t /*seed*/) : ways(ways), leaves(1) {
+        while (leaves < ways) {
+            leaves <<= 1;
+        }
+        words = (leaves + 63) / 64;
+        bits.assign(sets * words, 0);
+    }
+
+    void on_hit(uint32_t set, uint32_t way) { touch(set, way); }
+    void on_fill(uint32_t set, uint32_t way) { touch(set, way); }
+
+    uint32_t victim(uint32_t set) {
+        uint32_t node = 1;
+        while (node < leaves) {
+            uint32_t child = 2 * node + get(set, node);
+            if (leftmost_leaf(child) - leaves >= ways) {
+                child ^= 1; // 这棵子树全是补齐的路
+            }
+            node = child;
+        }
+        return node - leaves;
+    }
+
+private:
+    // 从叶子走到根，让沿途节点指向另一侧
+    void touch(uint32_t set, uint32_t way) {
+        for (uint32_t node = way + leaves; node > 1; node >>= 1) {
+            put(set, node >> 1, (node & 1) == 0);
+        }
+    }
+
+    uint32_t leftmost_leaf(uint32_t node) const {
+        while (node < leaves) {
+            node <<= 1;
+        }
+        return node;
+    }
+
+    uint32_t get(uint32_t set, uint32_t node) const {
+        return (bits[set * words + node / 64] >> (node % 64)) & 1;
+    }
+
+    void put(uint32_t set, uint32_t node, bool value) {
+        uint64_t& word = bits[set * words + node / 64];
+        word = (word & ~(1ull << (node % 64))) | ((uint64_t)value << (node % 64));
+    }
+
+    uint32_t ways;
+    uint32_t leaves;  // 补齐到 2 的幂的叶子数
+    uint32_t words;   // 每组占用的 64 位字数
+    std::vector<uint64_t> bits;
+};
+
+// RRIP 公共部分：每路 2 位重引用预测值（RRPV），每组打包在 64 位字中
+class RripBase {
+public:
+    static const uint32_t MAX_RRPV = 3;
+
+    RripBase(uint32_t sets, uint32_t ways)
+        : ways(ways), words((ways * 2 + 63) / 64), rrpv(sets * words, ~0ull) {}
+
+    void on_hit(uint32_t set, uint32_t way) { put(set, way, 0); }
+
+    // 找 RRPV 为最大值的路，找不到时整组老化
+    uint32_t victim(uint32_t set) {
+        while (true) {
+            for (uint32_t way = 0; way < ways; way++) {
+                if (get(set, way) == MAX_RRPV) {
+                    return way;
+                }
+            }
+            for (uint32_t way = 0; way < ways; way++) {
+                put(set, way, get(set, way) + 1);
+            }
+        }
+    }
+
+protected:
+    uint32_t get(uint32_t set, uint32_t way) const {
+        return (rrpv[set * words + way / 32] >> (2 * (way % 32))) & 3;
+    }
+
+    void put(uint32_t set, uint32_t way, uint32_t value) {
+        uint64_t& word = rrpv[set * words + way / 32];
+        uint32_t shift = 2 * (way % 32);
+        word = (word & ~(3ull << shift)) | ((uint64_t)value << shift);
+    }
+
+    // BRRIP 插入：大多数插到最远（MAX_RRPV），每 32 次有一次插到 MAX_RRPV - 1
+    uint32_t bimodal_rrpv() {
+        return (++throttle % 32 == 0) ? MAX_RRPV - 1 : MAX_RRPV;
+    }
+
+    uint32_t ways;
+    uint32_t words;
+    std::vector<uint64_t> rrpv;
+    uint32_t throttle = 0;
+};
+
+// SRRIP：新行插入为 MAX_RRPV - 1
+class SrripPolicy : public RripBase {
+public:
+    SrripPolicy(uint32_t sets, uint32_t ways, uint32_t /*seed*/) : RripBase(sets, ways) {}
+    void on_fill(uint32_t set, uint32_t way) { put(set, way, MAX_RRPV - 1); }
+};
+
+// BRRIP：新行大多插入为 MAX_RRPV，抗扫描
+class BrripPolicy : public RripBase {
+public:
+    BrripPolicy(uint32_t sets, uint32_t ways, uint32_t /*seed*/) : RripBase(sets, ways) {}
+    void on_fill(uint32_t set, uint32_t way) { put(set, way, bimodal_rrpv()); }
+};
+
+// DRRIP：组竞争（set dueling）。少数领导组固定使用 SRRIP 或 BRRIP，
+// 领导组的未命中调整 10 位饱和计数器 PSEL，其余组跟随未命中较少的一方。
+// 两种领导组各 max(1, sets / 32) 个：组号分成同样多的区段，第 k 段中
+// SRRIP 领导组在段内偏移 o = k % (段长 / 2) 处，BRRIP 领导组在其补位 段长 - 1 - o 处。
+// 少于 3 组时没有跟随组，不设领导组，PSEL 不变，退化为 SRRIP
+class DrripPolicy : public RripBase {
+public:
+    DrripPolicy(uint32_t sets, uint32_t ways, uint32_t /*seed*/) : RripBase(sets, ways), role(sets, FOLLOWER) {
+        if (sets < 3) {
+            return;
+        }
+        uint32_t leaders = sets / 32 > 1 ? sets / 32 : 1;
+        uint32_t span = sets / leaders;
+        for (uint32_t k = 0; k < leaders; k++) {
+            uint32_t offset = k % (span / 2);
+            role[k * span + offset] = SRRIP_LEADER;
+            role[k * span + span - 1 - offset] = BRRIP_LEADER;
+        }
+    }
+
+    void on_fill(uint32_t set, uint32_t way) {
+        bool brrip;
+        if (role[set] == SRRIP_LEADER) {
+            psel = psel < PSEL_MAX ? psel + 1 : psel;
+            brrip = false;
+        } else if (role[set] == BRRIP_LEADER) {
+            psel = psel > 0 ? psel - 1 : psel;
+            brrip = true;
+        } else {
+            brrip = psel > PSEL_MAX / 2; // SRRIP 领导组未命中更多
+        }
+        put(set, way, brrip ? bimodal_rrpv() : MAX_RRPV - 1);
+    }
+
+private:
+    static const uint32_t PSEL_MAX = 1023;
+    enum : uint8_t { FOLLOWER, SRRIP_LEADER, BRRIP_LEADER };
+
+    std::vector<uint8_t> role;    // 每组：跟随组或哪种领导组
+    uint32_t psel = PSEL_MAX / 2;
+};
+
+// FIFO：每组记录下一次被替换的路。路按 0 到 ways - 1 的顺序循环替换，只有填入的正是这一路时
+// 才前进；填到被失效后空出的路时不前进，最早填入的行仍先被替换（重新填入的路按原来的位置排队）
+class FifoPolicy {
+public:
+    FifoPolicy(uint32_t sets, uint32_t ways, uint32_t /*seed*/) : ways(ways), next(sets, 0) {}
+
+    void on_hit(uint32_t /*set*/, uint32_t /*way*/) {}
+    void on_fill(uint32_t set, uint32_t way) {
+        if (way == next[set]) {
+            next[set] = way + 1 == ways ? 0 : way + 1;
+        }
+    }
+    uint32_t victim(uint32_t set) { return next[set]; }
+
+private:
+    uint32_t ways;
+    std::vector<uint16_t> next;
+};
+
+// 随机替换：xorshift32，种子固定时结果可重现
+class RandomPolicy {
+public:
+    RandomPolicy(uint32_t /*sets*/, uint32_t ways, uint32_t seed) : ways(ways), state(seed ? seed : 1) {}
+
+    void on_hit(uint32_t /*set*/, uint32_t /*way*/) {}
+    void on_fill(uint32_t /*set*/, uint32_t /*way*/) {}
+
+    uint32_t victim(uint32_t /*set*/) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state % ways;
+    }
+
+private:
+    uint32_t ways;
+    uint32_t state;
+};
+
+#endif
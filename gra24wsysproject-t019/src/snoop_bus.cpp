@@ -0,0 +1,418 @@
+#include "snoop_bus.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+SnoopBus::SnoopBus(sc_module_name name, const CacheConfig& config) : sc_module(name),
+    config(config), line_size(config.levels.back().line_size),
+    hop(config.coherence == COHERENCE_DIRECTORY ? config.hop_latency : 0),
+    shared(make_cache_level(config.levels.back(), config.levels.size())),
+    shared_banks(config.levels.back()),
+    directory(config.coherence == COHERENCE_DIRECTORY ? config.directory_entries : 0, config.directory_ways,
+              line_size)
+{
+    for (uint32_t core = 0; core < config.cores; core++) {
+        links.emplace_back(new CoreLink);
+    }
+
+    SC_THREAD(process_bus);
+    sensitive << clk.neg();
+}
+
+void SnoopBus::connect(Cache& cache, uint32_t core) {
+    CoreLink& link = *links[core];
+    link.cache = &cache;
+    cache.mem_read(link.read);
+    cache.mem_write(link.write);
+    cache.mem_exclusive(link.exclusive);
+    cache.mem_address(link.address);
+    cache.mem_w_data(link.w_data);
+    cache.mem_req_id(link.req_id);
+    cache.mem_burst_len(link.burst_len);
+    cache.mem_w_line(link.w_line);
+    cache.mem_ready(link.ready);
+    cache.mem_full(link.full);
+    cache.mem_shared(link.shared);
+    cache.mem_r_data(link.r_data);
+    cache.mem_resp_id(link.resp_id);
+    cache.mem_r_line(link.r_line);
+}
+
+// 每个时钟下降沿：收取主存返回的数据和各核的请求，完成到期的事务，开始新的事务
+// （广播时只在总线空闲且本周期没有发出响应时），再向主存发出至多一条请求
+void SnoopBus::process_bus() {
+    while (true) {
+        wait();
+        cycle++;
+        mem_read.write(false);
+        mem_write.write(false);
+        for (std::unique_ptr<CoreLink>& link : links) {
+            link->ready.write(false);
+        }
+        responded.clear();
+
+        receive_memory();
+        receive_requests();
+        // 发出响应的周期请求方还没填好缓存行，同一行的下一个事务从下个周期开始
+        bool any = respond();
+        if (directory.enabled() || (!any && active.empty())) {
+            start();
+        }
+        issue_memory();
+
+        for (std::unique_ptr<CoreLink>& link : links) {
+            link->full.write(link->queue.size() >= QUEUE_DEPTH);
+        }
+        if (directory.enabled()) {
+            directory.sample();
+        }
+    }
+}
+
+// 收取主存返回的缓存行，填入共享缓存。写主存的响应直接忽略
+void SnoopBus::receive_memory() {
+    if (!mem_ready.read()) {
+        return;
+    }
+    for (Transaction& t : active) {
+        if (t.waiting_memory && mem_resp_id.read() == t.mem_id) {
+            t.line = mem_r_line.read();
+            t.line.size = line_size;
+            fill_shared(t.request.addr, t.line, false);
+            t.waiting_memory = false;
+            t.done = std::max(t.done, cycle + hop);
+            memory_reads++;
+            return;
+        }
+    }
+}
+
+// 取数请求排队等待仲裁；写回不需要监听，到达时直接写入共享缓存
+void SnoopBus::receive_requests() {
+    for (std::unique_ptr<CoreLink>& link : links) {
+        uint32_t addr = link->address.read();
+        if (link->read.read()) {
+            link->queue.push_back(Request{link->req_id.read(), addr & ~(line_size - 1), link->exclusive.read(), cycle});
+        } else if (link->write.read() && link->burst_len.read()) {
+            fill_shared(addr, link->w_line.read(), true);
+            writebacks++;
+        } else if (link->write.read()) {
+            // 私有缓存写分配、末级写回，按配置不会单字写穿到总线；保险起见照常写下去
+            bool hit = false;
+            shared_banks.reserve(addr, cycle);
+            std::visit([&](auto& cache) { hit = cache.write_word(addr, link->w_data.read(), true); }, shared);
+            if (!hit) {
+                send_memory(true, addr, 0, link->w_data.read(), nullptr, cycle);
+                memory_writes++;
+            }
+        }
+    }
+}
+
+// 从上次仲裁到的下一个核开始，找队首请求的行没有事务在处理的核。
+// 目录模式下先为这一行分配目录项，组内各项都在处理事务时这个核等待
+void SnoopBus::start() {
+    for (uint32_t i = 0; i < links.size(); i++) {
+        uint32_t core = (next_core + i) % links.size();
+        std::deque<Request>& queue = links[core]->queue;
+        if (queue.empty() || busy_line(queue.front().addr)) {
+            continue;
+        }
+        if (directory.enabled()) {
+            bool evicted = false;
+            uint32_t victim_addr = 0;
+            uint64_t victim_sharers = 0;
+            auto pinned = [this](uint32_t addr) { return busy_line(addr); };
+            if (!directory.allocate(queue.front().addr, pinned, evicted, victim_addr, victim_sharers)) {
+                continue;
+            }
+            if (evicted) {
+                evict_entry(victim_addr, victim_sharers);
+            }
+        }
+        next_core = core + 1;
+        Request request = queue.front();
+        queue.pop_front();
+        begin(core, request);
+        return;
+    }
+}
+
+// 开始一个事务：监听其他核（目录模式下只监听记录的共享者），确定数据来源和响应时间
+void SnoopBus::begin(uint32_t core, const Request& request) {
+    Transaction t;
+    t.requester = core;
+    t.request = request;
+    t.shared = false;
+    t.invalidated = 0;
+    t.hops = 2;
+    t.waiting_memory = false;
+    t.mem_id = 0;
+    t.done = 0;
+
+    if (request.exclusive) {
+        getm++;
+    } else {
+        gets++;
+    }
+
+    // 请求方仍持有共享的副本时只需升级，它的数据就是最新的
+    bool supplied = false;
+    if (request.exclusive) {
+        supplied = links[core]->cache->snoop(SNOOP_PEEK, request.addr, false, t.line).held;
+    }
+    bool upgrade = supplied;
+
+    uint64_t requester_bit = 1ull << core;
+    uint64_t targets = directory.enabled() ? directory.sharers(request.addr) : ~0ull;
+    uint64_t sharers = requester_bit;
+    bool moesi = config.protocol == PROTOCOL_MOESI;
+    for (uint32_t other = 0; other < links.size(); other++) {
+        if (other == core || !((targets >> other) & 1)) {
+            continue;
+        }
+        snoops++;
+        MemLine copy;
+        SnoopResult result = links[other]->cache->snoop(request.exclusive ? SNOOP_INVALIDATE : SNOOP_SHARE,
+                                                        request.addr, moesi, copy);
+        if (!result.supplied) {
+            continue;
+        }
+        // 各核持有的副本都相同，取第一份
+        if (!supplied) {
+            t.line = copy;
+            supplied = true;
+        }
+        if (result.held && request.exclusive) {
+            t.invalidated++;
+        } else if (result.held) {
+            t.shared = true;
+            sharers |= 1ull << other;
+        }
+        // 读的时候脏数据没有核继续负责（MESI 降为共享，或取消了还没发出的写回），写入共享缓存
+        if (!request.exclusive && result.dirty && !result.owner) {
+            fill_shared(request.addr, copy, true);
+            flushes++;
+        }
+    }
+    if (t.invalidated) {
+        invalidations += t.invalidated;
+        invalidating++;
+    }
+    // 已经不持有的核（悄悄丢弃了干净行）从共享者中去掉
+    directory.set_sharers(request.addr, sharers);
+
+    // 目录模式：请求到目录一跳，查目录 bus_latency；转发给持有者、持有者送回数据各一跳，
+    // 失效确认从被失效的核直接送给请求方。广播时 hop 为 0
+    uint64_t probe = cycle + hop + config.bus_latency;
+    if (upgrade) {
+        t.source = FROM_OWN;
+        t.done = probe + hop;
+    } else if (supplied) {
+        t.source = FROM_CACHE;
+        t.done = probe + hop + config.transfer_latency + hop;
+        t.hops = 3;
+    } else {
+        bool hit = false;
+        std::visit([&](auto& cache) {
+            uint32_t word = 0;
+            hit = cache.read_word(request.addr, word);
+            if (hit) {
+                std::memcpy(t.line.bytes, cache.peek_line(request.addr), line_size);
+            }
+        }, shared);
+        // 查共享缓存要等存储体的端口（或流水线的入口），未命中时查完标签就去主存
+        const CacheLevelConfig& shared_config = config.levels.back();
+        uint64_t access = shared_banks.reserve(request.addr, probe) +
+                          (hit ? shared_config.latency : shared_config.miss_latency());
+        if (hit) {
+            t.source = FROM_SHARED;
+            t.done = access + hop;
+        } else {
+            t.source = FROM_MEMORY;
+            t.waiting_memory = true;
+            t.mem_id = send_memory(false, request.addr, line_size, 0, nullptr, access);
+        }
+    }
+    if (t.invalidated && hop) {
+        t.done = std::max(t.done, probe + hop + hop);
+        t.hops = 3;
+    }
+    t.line.size = line_size;
+    active.push_back(t);
+}
+
+// 数据就绪的事务向请求方发出响应（保持一个周期），每个核每周期至多一个。返回是否发出了响应
+bool SnoopBus::respond() {
+    uint64_t served = 0;  // 本周期已收到响应的核
+    bool any = false;
+    for (auto it = active.begin(); it != active.end(); ) {
+        uint64_t bit = 1ull << it->requester;
+        if (it->waiting_memory || it->done > cycle || (served & bit)) {
+            ++it;
+            continue;
+        }
+
+        CoreLink& link = *links[it->requester];
+        link.r_line.write(it->line);
+        link.resp_id.write(it->request.id);
+        link.shared.write(it->shared);
+        link.ready.write(true);
+        served |= bit;
+        any = true;
+
+        uint64_t latency = cycle - it->request.arrival;
+        counts[it->source]++;
+        latencies[it->source] += latency;
+        if (it->invalidated) {
+            invalidating_latency += latency;
+        }
+        if (hop) {
+            hop_counts[it->hops - 2]++;
+            hop_latencies[it->hops - 2] += latency;
+        }
+        responded.push_back(it->request.addr);
+        it = active.erase(it);
+    }
+    return any;
+}
+
+// 这一行有事务正在处理，或本周期刚发出响应
+bool SnoopBus::busy_line(uint32_t addr) const {
+    for (const Transaction& t : active) {
+        if (t.request.addr == addr) {
+            return true;
+        }
+    }
+    for (uint32_t line_addr : responded) {
+        if (line_addr == addr) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 目录项被替换：让它记录的各核的副本失效，脏数据写入共享缓存。不在请求的关键路径上
+void SnoopBus::evict_entry(uint32_t addr, uint64_t sharers) {
+    for (uint32_t core = 0; core < links.size(); core++) {
+        if (!((sharers >> core) & 1)) {
+            continue;
+        }
+        snoops++;
+        MemLine copy;
+        SnoopResult result = links[core]->cache->snoop(SNOOP_INVALIDATE, addr, false, copy);
+        if (result.held) {
+            eviction_invalidations++;
+        }
+        if (result.dirty) {
+            fill_shared(addr, copy, true);
+            flushes++;
+        }
+    }
+}
+
+// 向主存发出队首的请求（保持一个周期）。full 为高时等待
+void SnoopBus::issue_memory() {
+    if (mem_queue.empty() || mem_queue.front().issue > cycle || mem_full.read()) {
+        return;
+    }
+
+    const MemOut& out = mem_queue.front();
+    mem_address.write(out.addr);
+    mem_w_data.write(out.data);
+    mem_req_id.write(out.id);
+    mem_burst_len.write(out.burst_len);
+    if (out.write && out.burst_len) {
+        mem_w_line.write(out.line);
+    }
+    mem_read.write(!out.write);
+    mem_write.write(out.write);
+    mem_queue.pop_front();
+}
+
+// 把一整行写入共享缓存，已在其中时直接更新。替换出的脏行写回主存
+void SnoopBus::fill_shared(uint32_t addr, const MemLine& data, bool dirty) {
+    shared_banks.reserve(addr, cycle);
+    bool hit = false;
+    if (dirty) {
+        std::visit([&](auto& cache) { hit = cache.write_line(addr, data.bytes, line_size, true); }, shared);
+    }
+    if (hit) {
+        return;
+    }
+
+    MemLine victim;
+    uint32_t victim_addr = 0;
+    bool victim_dirty = false;
+    bool evicted = false;
+    std::visit([&](auto& cache) {
+        evicted = cache.fill_line(addr, data.bytes, dirty, victim_addr, victim_dirty, victim.bytes);
+    }, shared);
+    if (evicted && victim_dirty) {
+        victim.size = line_size;
+        send_memory(true, victim_addr, line_size, 0, &victim, cycle);
+        memory_writebacks++;
+    }
+}
+
+// 把一条主存请求放入发送队列，返回请求编号。按入队顺序发出，
+// 同一地址的写回和之后的读按顺序到达主存
+uint32_t SnoopBus::send_memory(bool is_write, uint32_t addr, uint32_t burst_len, uint32_t data,
+                               const MemLine* line, uint64_t issue) {
+    MemOut out;
+    out.write = is_write;
+    out.addr = addr;
+    out.burst_len = burst_len;
+    out.data = data;
+    if (line) {
+        out.line = *line;
+    }
+    out.id = allocate_id();
+    out.issue = issue;
+    mem_queue.push_back(out);
+    return out.id;
+}
+
+// 分配主存请求编号：编号回绕后跳过 0 和还在等待主存数据的事务正在使用的编号
+uint32_t SnoopBus::allocate_id() {
+    while (true) {
+        uint32_t id = next_id++;
+        bool in_use = id == 0;
+        for (size_t i = 0; i < active.size() && !in_use; i++) {
+            in_use = active[i].waiting_memory && active[i].mem_id == id;
+        }
+        if (!in_use) {
+            return id;
+        }
+    }
+}
+
+void SnoopBus::print_stats(std::ostream& os) const {
+    static const char* const SOURCE_NAMES[] = {"upgrades", "cache-to-cache transfers", "shared cache hits",
+                                               "memory fetches"};
+    uint64_t transactions = gets + getm;
+    os << std::dec << "Bus (" << links.size() << " cores, " << (config.protocol == PROTOCOL_MOESI ? "MOESI" : "MESI")
+       << (directory.enabled() ? ", directory" : ", snooping") << "): GetS " << gets << ", GetM " << getm
+       << ", writebacks " << writebacks << ", flushes " << flushes << std::endl;
+    for (int s = 0; s < SOURCES; s++) {
+        os << "  " << SOURCE_NAMES[s] << ": " << counts[s] << ", avg latency "
+           << (counts[s] ? (double)latencies[s] / counts[s] : 0.0) << " cycles" << std::endl;
+    }
+    os << "  snoops: " << snoops << " (" << (transactions ? (double)snoops / transactions : 0.0)
+       << " per transaction)" << std::endl;
+    os << "  invalidations: " << invalidations << " copies in " << invalidating << " transactions, avg latency "
+       << (invalidating ? (double)invalidating_latency / invalidating : 0.0) << " cycles" << std::endl;
+    if (directory.enabled()) {
+        for (int h = 0; h < 2; h++) {
+            os << "  " << h + 2 << "-hop: " << hop_counts[h] << ", avg latency "
+               << (hop_counts[h] ? (double)hop_latencies[h] / hop_counts[h] : 0.0) << " cycles" << std::endl;
+        }
+        directory.print_stats(os);
+        os << "  invalidations caused by directory evictions: " << eviction_invalidations << " copies" << std::endl;
+    }
+    if (shared_banks.enabled()) {
+        shared_banks.print_stats(os, config.levels.size() - 1, cycle);
+    }
+    os << "Shared cache memory line reads: " << memory_reads << ", line writebacks: " << memory_writebacks
+       << ", word writes: " << memory_writes << std::endl;
+}
@@ -0,0 +1,168 @@
+#ifndef SNOOP_BUS_HPP
+#define SNOOP_BUS_HPP
+
+#include <systemc.h>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "cache.hpp"
+#include "cache_banks.hpp"
+#include "cache_config.hpp"
+#include "cache_level.hpp"
+#include "mem_line.hpp"
+#include "snoop_filter.hpp"
+
+// 多核的一致性总线和共享缓存。CacheConfig 的最后一级是各核共享的缓存，放在总线里面；
+// 每个核的私有缓存是按 private_config() 建立的 Cache，由 connect 接到总线上。
+// 写无效的监听协议 MESI（可选 MOESI）：
+//   - 总线在时钟下降沿工作。私有缓存在上升沿发请求、收响应，下降沿时它们的状态都已确定，
+//     总线直接调用 Cache::snoop 监听，能看到包括还没发出的写回在内的全部副本
+//   - 事务开始时一次完成监听和状态变化（原子的），数据按延迟稍后送到。同一缓存行在响应送到、
+//     请求方填好之前不开始新的事务
+//   - 读（GetS）：其他核的副本降为共享，由持有者直接提供数据（cache-to-cache）。
+//     MESI 中脏数据同时写回共享缓存；MOESI 中留在原核（O 状态），由它负责写回。
+//     其他核都没有时请求方得到独占（E）的行
+//   - 为写取数据（GetM）：其他核的副本失效，脏数据连同写回的责任交给请求方；
+//     请求方仍持有共享的副本时为升级，不传数据
+//   - 其他核都没有时读共享缓存，缺失时经 mem_* 端口从 Memory 取回
+//   - 私有缓存的写回到达时立即写入共享缓存
+// 找到其他核副本的方式（coherence）：
+//   - snoop：广播，监听所有其他核；总线同一时刻只处理一个事务
+//   - directory：共享缓存旁的稀疏目录（SnoopFilter）记录每行的共享者，只监听它们，
+//     每周期可开始一个事务，不同行的事务同时进行。目录项被替换时它记录的副本全部失效。
+//     延迟按跳数计：请求到目录一跳，目录或共享缓存直接回数据为 2 跳；
+//     转发给持有者再由它把数据送给请求方，或等待失效确认时为 3 跳
+// 每个核的请求在总线上排队，按轮转顺序仲裁
+class SnoopBus : public sc_module {
+public:
+    sc_in<bool> clk;
+
+    // 连接到主存
+    sc_out<bool> mem_read;
+    sc_out<bool> mem_write;
+    sc_out<uint32_t> mem_address;
+    sc_out<uint32_t> mem_w_data;
+    sc_out<uint32_t> mem_req_id;
+    sc_in<bool> mem_ready;
+    sc_in<bool> mem_full;
+    sc_in<uint32_t> mem_r_data;
+    sc_in<uint32_t> mem_resp_id;
+    sc_out<uint32_t> mem_burst_len;
+    sc_out<MemLine> mem_w_line;
+    sc_in<MemLine> mem_r_line;
+
+    SC_HAS_PROCESS(SnoopBus);
+
+    // config 须已通过 CacheConfig::validate 检查，核数为 config.cores
+    SnoopBus(sc_module_name name, const CacheConfig& config);
+
+    // 把第 core 个核的私有缓存的 mem_* 端口接到总线上
+    void connect(Cache& cache, uint32_t core);
+
+    // 按数据来源打印事务的次数和平均延迟（从请求到达总线到响应），以及失效和写回的次数；
+    // 目录模式下还有按跳数的延迟和目录的压力（替换、替换引起的失效、占用）
+    void print_stats(std::ostream& os) const;
+
+private:
+    static const uint32_t QUEUE_DEPTH = 8;  // 每个核在总线上排队的请求数
+
+    // 取数事务的数据来源
+    enum Source {
+        FROM_OWN,     // 升级：请求方自己的副本
+        FROM_CACHE,   // 其他核的私有缓存
+        FROM_SHARED,  // 共享缓存
+        FROM_MEMORY,
+        SOURCES
+    };
+
+    struct Request {
+        uint32_t id;
+        uint32_t addr;     // 缓存行地址
+        bool exclusive;    // GetM
+        uint64_t arrival;  // 到达总线的周期
+    };
+
+    // 一个核与总线之间的信号，与 Cache 的 mem_* 端口一一对应
+    struct CoreLink {
+        sc_signal<bool> read, write, exclusive, ready, full, shared;
+        sc_signal<uint32_t> address, w_data, req_id, burst_len, r_data, resp_id;
+        sc_signal<MemLine> w_line, r_line;
+        Cache* cache = nullptr;
+        std::deque<Request> queue;
+    };
+
+    // 等待发给主存的请求，按先后顺序每周期发出一个
+    struct MemOut {
+        bool write;
+        uint32_t addr;
+        uint32_t burst_len;  // 0 表示单字访问
+        uint32_t data;
+        MemLine line;
+        uint32_t id;
+        uint64_t issue;      // 最早发出的周期
+    };
+
+    // 正在处理的事务
+    struct Transaction {
+        uint32_t requester;
+        Request request;
+        Source source;
+        bool shared;          // 响应时告诉请求方其他核也有副本
+        uint32_t invalidated; // 失效的其他核的副本数
+        uint32_t hops;        // 目录模式下的跳数
+        bool waiting_memory;
+        uint32_t mem_id;
+        uint64_t done;        // 数据就绪、可以响应的周期
+        MemLine line;         // 送给请求方的缓存行
+    };
+
+    void process_bus();
+    void receive_memory();
+    void receive_requests();
+    void start();
+    void begin(uint32_t core, const Request& request);
+    bool respond();
+    void issue_memory();
+    bool busy_line(uint32_t addr) const;
+    void evict_entry(uint32_t addr, uint64_t sharers);
+    void fill_shared(uint32_t addr, const MemLine& line, bool dirty);
+    uint32_t send_memory(bool is_write, uint32_t addr, uint32_t burst_len, uint32_t data, const MemLine* line,
+                         uint64_t issue);
+    uint32_t allocate_id();
+
+    CacheConfig config;
+    uint32_t line_size;
+    uint32_t hop;                                  // 每一跳的周期数，广播时为 0
+    AnyCacheLevel shared;                          // 共享缓存（配置的最后一级）
+    CacheBanks shared_banks;                       // 共享缓存的存储体，各核的访问在这里竞争端口
+    SnoopFilter directory;                         // 广播时不启用
+    std::vector<std::unique_ptr<CoreLink> > links;
+    uint32_t next_core = 0;                        // 轮转仲裁从这个核开始
+    uint64_t cycle = 0;
+    uint32_t next_id = 1;                          // 下一个主存请求编号，回绕时跳过 0 和仍在等待的编号
+    std::deque<MemOut> mem_queue;
+    std::vector<Transaction> active;
+    std::vector<uint32_t> responded;               // 本周期发出响应的行，下个周期才能开始新的事务
+
+    // 统计
+    uint64_t gets = 0;
+    uint64_t getm = 0;
+    uint64_t counts[SOURCES] = {};
+    uint64_t latencies[SOURCES] = {};
+    uint64_t snoops = 0;                // 向其他核发出的监听
+    uint64_t invalidations = 0;         // 失效的副本
+    uint64_t invalidating = 0;          // 失效了副本的事务
+    uint64_t invalidating_latency = 0;
+    uint64_t eviction_invalidations = 0;  // 目录项被替换时失效的副本
+    uint64_t hop_counts[2] = {};        // 2 跳、3 跳的事务
+    uint64_t hop_latencies[2] = {};
+    uint64_t flushes = 0;               // 降为共享（或取消写回）时写入共享缓存的脏行
+    uint64_t writebacks = 0;            // 私有缓存替换出的脏行
+    uint64_t memory_reads = 0;
+    uint64_t memory_writebacks = 0;
+    uint64_t memory_writes = 0;         // 单字写
+};
+
+#endif
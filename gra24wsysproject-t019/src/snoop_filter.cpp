@@ -0,0 +1,59 @@
+#include "snoop_filter.hpp"
+
+SnoopFilter::SnoopFilter(uint32_t entries, uint32_t ways, uint32_t line_size)
+    : ways(ways), sets(entries ? entries / ways : 0), set_bits(log2_exact(sets)),
+      line_shift(log2_exact(line_size)), line_mask(line_size - 1),
+      table(entries, Entry{false, 0, 0, 0}) {}
+
+int SnoopFilter::find(uint32_t addr) const {
+    if (table.empty()) {
+        return -1;
+    }
+    uint32_t line_addr = addr & ~line_mask;
+    uint32_t base = set_of(addr) * ways;
+    for (uint32_t way = 0; way < ways; way++) {
+        const Entry& entry = table[base + way];
+        if (entry.valid && entry.addr == line_addr) {
+            return base + way;
+        }
+    }
+    return -1;
+}
+
+uint64_t SnoopFilter::sharers(uint32_t addr) {
+    lookups++;
+    int index = find(addr);
+    if (index < 0) {
+        return 0;
+    }
+    table[index].last_use = ++stamp;
+    return table[index].sharers;
+}
+
+void SnoopFilter::set_sharers(uint32_t addr, uint64_t sharers) {
+    int index = find(addr);
+    if (index < 0) {
+        return;
+    }
+    table[index].sharers = sharers;
+    if (!sharers) {
+        table[index].valid = false;
+        occupancy--;
+    }
+}
+
+void SnoopFilter::sample() {
+    cycles++;
+    occupancy_sum += occupancy;
+    if (occupancy > max_occupancy) {
+        max_occupancy = occupancy;
+    }
+}
+
+void SnoopFilter::print_stats(std::ostream& os) const {
+    os << std::dec << "Directory (" << table.size() << " entries, " << ways << " ways): lookups " << lookups
+       << ", allocations " << allocations << ", evictions " << evictions << " ("
+       << evicted_sharers << " sharers), stalls " << stalls << std::endl;
+    os << "  occupancy avg " << (cycles ? (double)occupancy_sum / cycles : 0.0) << ", max " << max_occupancy
+       << " entries" << std::endl;
+}
@@ -0,0 +1,109 @@
+#ifndef SNOOP_FILTER_HPP
+#define SNOOP_FILTER_HPP
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "cache_geometry.hpp"
+
+// 稀疏目录（snoop filter）：共享缓存旁的组相联表，每项记录一条缓存行在哪些核的私有缓存中
+// （共享者位图，每核一位，最多 64 核）。位图是保守的：私有缓存悄悄丢弃干净行时不通知目录，
+// 监听发现某核已不持有时才清掉它的位。反过来目录一定覆盖所有副本——替换掉一项前，
+// 总线先让它记录的各核的副本失效（目录替换引起的失效）。
+// 组号为行号乘以黄金分割常数后的高位（Fibonacci 散列），各核对齐的私有数据不会集中在少数几组。
+// 按 LRU 替换，正在处理事务的行不能被替换
+class SnoopFilter {
+public:
+    // entries 为 0 时不启用。entries / ways 须为 2 的幂
+    SnoopFilter(uint32_t entries, uint32_t ways, uint32_t line_size);
+
+    bool enabled() const { return !table.empty(); }
+
+    // 返回包含 addr 的缓存行的共享者位图，没有记录时返回 0
+    uint64_t sharers(uint32_t addr);
+
+    // 为包含 addr 的缓存行分配一项（已有时直接返回 true）。组满时替换最久未用、
+    // pinned(行地址) 为 false 的一项：evicted 置 true，它的行地址和共享者写入
+    // victim_addr / victim_sharers。组内各项都不能替换时返回 false
+    template <typename Pinned>
+    bool allocate(uint32_t addr, Pinned pinned, bool& evicted, uint32_t& victim_addr, uint64_t& victim_sharers) {
+        evicted = false;
+        if (find(addr) >= 0) {
+            return true;
+        }
+        uint32_t base = set_of(addr) * ways;
+        int victim = -1;
+        for (uint32_t way = 0; way < ways; way++) {
+            const Entry& entry = table[base + way];
+            if (!entry.valid) {
+                victim = base + way;
+                break;
+            }
+            if (!pinned(entry.addr) && (victim < 0 || entry.last_use < table[victim].last_use)) {
+                victim = base + way;
+            }
+        }
+        if (victim < 0) {
+            stalls++;
+            return false;
+        }
+
+        Entry& entry = table[victim];
+        if (entry.valid) {
+            evicted = true;
+            victim_addr = entry.addr;
+            victim_sharers = entry.sharers;
+            evictions++;
+            evicted_sharers += __builtin_popcountll(entry.sharers);
+        } else {
+            occupancy++;
+        }
+        entry = Entry{true, addr & ~line_mask, 0, ++stamp};
+        allocations++;
+        return true;
+    }
+
+    // 更新包含 addr 的缓存行的共享者位图，为 0 时释放这一项
+    void set_sharers(uint32_t addr, uint64_t sharers);
+
+    // 每个周期调用一次，统计占用
+    void sample();
+
+    void print_stats(std::ostream& os) const;
+
+private:
+    struct Entry {
+        bool valid;
+        uint32_t addr;      // 缓存行地址
+        uint64_t sharers;
+        uint64_t last_use;  // LRU
+    };
+
+    int find(uint32_t addr) const;
+    uint32_t set_of(uint32_t addr) const {
+        uint32_t line = addr >> line_shift;
+        return set_bits ? (line * 0x9E3779B1u) >> (32 - set_bits) : 0;
+    }
+
+    uint32_t ways;
+    uint32_t sets;
+    uint32_t set_bits;         // log2(sets)
+    uint32_t line_shift;       // log2(line_size)
+    uint32_t line_mask;        // line_size - 1
+    std::vector<Entry> table;  // sets * ways
+    uint64_t stamp = 0;
+    uint32_t occupancy = 0;    // 有效的项数
+
+    // 统计
+    uint64_t lookups = 0;
+    uint64_t allocations = 0;      // 请求的行没有目录项
+    uint64_t evictions = 0;
+    uint64_t evicted_sharers = 0;  // 被替换的项记录的共享者位数
+    uint64_t stalls = 0;           // 组内各项都在处理事务，请求等待
+    uint64_t cycles = 0;
+    uint64_t occupancy_sum = 0;
+    uint32_t max_occupancy = 0;
+};
+
+#endif
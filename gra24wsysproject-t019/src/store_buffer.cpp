@@ -0,0 +1,62 @@
+#include "store_buffer.hpp"
+
+const StoreBuffer::Entry* StoreBuffer::find(uint32_t addr) const {
+    uint32_t line_addr = addr & ~(line_size - 1);
+    for (const Entry& entry : entries) {
+        if (entry.line_addr == line_addr) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool StoreBuffer::has_line(uint32_t addr) const {
+    return find(addr) != nullptr;
+}
+
+bool StoreBuffer::store(uint32_t addr, uint32_t data, uint64_t cycle) {
+    Entry* entry = find(addr);
+    if (entry) {
+        coalesced++;
+    } else {
+        if (full()) {
+            return false;
+        }
+        entries.push_back(Entry{addr & ~(line_size - 1), 0, 0, {}});
+        entry = &entries.back();
+    }
+
+    uint32_t word = (addr & (line_size - 1)) / 4;
+    entry->words[word] = data;
+    entry->mask |= 1ull << word;
+    entry->last_store = cycle;
+    stores++;
+    return true;
+}
+
+bool StoreBuffer::forward(uint32_t addr, uint32_t& data) {
+    const Entry* entry = find(addr);
+    uint32_t word = (addr & (line_size - 1)) / 4;
+    if (!entry || !((entry->mask >> word) & 1)) {
+        return false;
+    }
+    data = entry->words[word];
+    forwarded++;
+    return true;
+}
+
+void StoreBuffer::pop() {
+    drains++;
+    entries.pop_front();
+}
+
+void StoreBuffer::sample() {
+    if (enabled() && full()) {
+        full_cycles++;
+    }
+}
+
+void StoreBuffer::print_stats(std::ostream& os) const {
+    os << std::dec << "Store buffer (" << capacity << " entries): stores " << stores << ", coalesced " << coalesced
+       << ", forwarded loads " << forwarded << ", drains " << drains << ", full cycles " << full_cycles << std::endl;
+}
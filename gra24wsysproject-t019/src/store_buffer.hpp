@@ -0,0 +1,73 @@
+#ifndef STORE_BUFFER_HPP
+#define STORE_BUFFER_HPP
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+
+#include "mem_line.hpp"
+
+// 合并写的存储缓冲，位于请求方和 L1 之间。每个表项对应一条 L1 缓存行，按对齐的字记录写入的数据：
+// 写同一行的存储合并到同一表项，之后读表项中的字直接转发。表项按进入的先后顺序
+// 在缓存空闲的周期排空，一次把整个表项写入 L1；最新的表项在还有存储合并进来时暂不排空。
+// 项数很少（最多 64），查找为线性扫描。
+// 只用于单核：一致性监听不查看缓冲，多核配置中不允许使用（见 CacheConfig::validate_multicore）
+class StoreBuffer {
+public:
+    static const uint32_t MAX_ENTRIES = 64;
+    static const uint32_t MAX_WORDS = MemLine::MAX_SIZE / 4;
+
+    struct Entry {
+        uint32_t line_addr;
+        uint64_t mask;                          // 写过、还没排空的字
+        uint64_t last_store;                    // 最近一次写入的周期
+        std::array<uint32_t, MAX_WORDS> words;
+    };
+
+    StoreBuffer(uint32_t entries, uint32_t line_size) : capacity(entries), line_size(line_size) {}
+
+    bool enabled() const { return capacity > 0; }
+    bool empty() const { return entries.empty(); }
+    bool full() const { return enabled() && entries.size() >= capacity; }
+
+    // 缓冲中是否有 addr 所在缓存行的表项
+    bool has_line(uint32_t addr) const;
+
+    // 在第 cycle 周期写入 addr 处对齐的字，该行已有表项时合并。需要新表项而缓冲已满时返回 false
+    bool store(uint32_t addr, uint32_t data, uint64_t cycle);
+
+    // addr 处对齐的字在缓冲中时转发给读，否则返回 false
+    bool forward(uint32_t addr, uint32_t& data);
+
+    // 第 cycle 周期是否可以排空最早的表项：后面还有表项，或者本周期没有写入它
+    bool drainable(uint64_t cycle) const {
+        return entries.size() > 1 || (!entries.empty() && entries.front().last_store < cycle);
+    }
+
+    // 最早的表项。排空时逐字清除 mask，全部写入后 pop
+    Entry& front() { return entries.front(); }
+    void pop();
+
+    // 每周期采样一次，统计缓冲满的周期
+    void sample();
+
+    void print_stats(std::ostream& os) const;
+
+private:
+    const Entry* find(uint32_t addr) const;
+    Entry* find(uint32_t addr) { return const_cast<Entry*>(static_cast<const StoreBuffer*>(this)->find(addr)); }
+
+    uint32_t capacity;
+    uint32_t line_size;
+    std::deque<Entry> entries;  // 最早进入的在前
+
+    // 统计
+    uint64_t stores = 0;
+    uint64_t coalesced = 0;     // 合并到已有表项的存储
+    uint64_t forwarded = 0;
+    uint64_t drains = 0;        // 排空的表项
+    uint64_t full_cycles = 0;
+};
+
+#endif
@@ -1,177 +1,368 @@
 #include <systemc.h>
 #include <vector>
 #include <iostream>
+#include <memory>
+#include <string>
 
-// Cache 模块定义
-class Cache : public sc_module {
-public:
-    // Ports
-    sc_in<bool> clk;          // 时钟信号
-    sc_in<bool> read;         // 读操作信号
-    sc_in<bool> write;        // 写操作信号
-    sc_in<uint32_t> address;  // 地址信号
-    sc_in<uint32_t> w_data;   // 写入数据信号
-    sc_out<uint32_t> r_data;  // 读出数据信号
-    sc_out<bool> ready;       // 操作完成信号
-
-    SC_CTOR(Cache);
-
-private:
-    struct CacheLine {
-        bool valid;
-        uint32_t tag;
-        std::vector<uint8_t> data;
-    };
-
-    // 缓存数据结构
-    std::vector<std::vector<CacheLine> > caches; // 多级缓存
-    std::vector<uint32_t> cache_sizes;          // 每级缓存大小
-    std::vector<uint32_t> line_sizes;           // 每级缓存行大小
-    std::vector<uint32_t> latencies;            // 每级缓存访问延迟
+#include "cache.hpp"
+#include "memory.hpp"
+#include "mmu.hpp"
+#include "page_table.hpp"
 
-    uint8_t levels = 2; // 默认两级缓存（可以扩展）
+// 主程序：缓存层次结构连接到主存
+int sc_main(int argc, char** argv) {
+    sc_signal<bool> w_signal, r_signal, ready_signal, full_signal;
+    sc_signal<uint32_t> wdata, addr, rdata, req_id, resp_id, pc;
+    sc_clock clk_signal("clk_signal", 10, SC_NS);
 
-    void process_cache();
-    bool search_cache(uint32_t level, uint32_t addr, uint32_t& data);
-    void update_cache(uint32_t level, uint32_t addr, uint32_t data);
-};
+    // 缓存与主存之间的信号
+    sc_signal<bool> mem_w_signal, mem_r_signal, mem_ready_signal, mem_full_signal;
+    sc_signal<bool> mem_exclusive, mem_shared;  // 单核时直接连主存，不需要一致性
+    sc_signal<uint32_t> mem_wdata, mem_addr, mem_rdata, mem_req_id, mem_resp_id, mem_burst_len;
+    sc_signal<MemLine> mem_wline, mem_rline;
 
-// 构造函数：初始化多级缓存
-Cache::Cache(sc_module_name name) : sc_module(name), 
-    cache_sizes{1024, 2048}, line_sizes{64, 64}, latencies{1, 3} 
-{
+    // 配置了虚拟内存时请求方的地址是虚拟地址，先经过 Mmu 翻译，Mmu 与缓存之间另用一组信号
+    sc_signal<bool> c_w_signal, c_r_signal, c_ready_signal, c_full_signal;
+    sc_signal<uint32_t> c_wdata, c_addr, c_rdata, c_req_id, c_resp_id, c_pc;
 
-    caches.resize(levels);
-    for (uint8_t i = 0; i < levels; i++) {
-        uint32_t num_lines = cache_sizes[i] / line_sizes[i];
-        caches[i].resize(num_lines, {false, 0, std::vector<uint8_t>(line_sizes[i], 0)});
+    // 命令行参数：配置文件名，或 key=value 形式的单项配置（例如 L2.ways=8、
+    // inclusion=exclusive、write_allocate=false、L1.prefetch=stream、L1.victim=4、vm=true page_size=2M），
+    // 按顺序应用，后面的覆盖前面的
+    CacheConfig config;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool ok = arg.find('=') != std::string::npos ? config.parse_option(arg) : config.load(arg);
+        if (!ok) {
+            return 1;
+        }
     }
+    if (!config.validate()) {
+        return 1;
+    }
+    if (config.cores > 1) {
+        std::cerr << "stufecache simulates a single core, use multicore for cores=" << config.cores << std::endl;
+        return 1;
+    }
+    config.print(std::cout);
 
-    SC_THREAD(process_cache);
-    sensitive << clk.pos();
-}
+    // 实例化缓存模块
+    Cache cache("Cache", config);
+    Memory memory("Memory");
 
-// 处理缓存逻辑
-void Cache::process_cache() {
-    while (true) {
-        wait();
-        ready.write(false);
-
-        uint32_t addr = address.read();
-        uint32_t data = 0;
-
-        if (read.read()) {
-            bool hit = false;
-
-            // 逐级检查缓存
-            for (uint8_t level = 0; level < levels; level++) {
-                if (search_cache(level, addr, data)) {
-                    std::cout << "Cache hit at level " << (int)level + 1 << std::endl;
-                    r_data.write(data);
-                    hit = true;
-                    wait(latencies[level], SC_NS); // 模拟延迟
-                    break;
-                }
-            }
+    // 虚拟内存：从 0 开始映射 2 MiB（覆盖下面所有测试用到的地址），页表放在物理地址 1 MiB 处，
+    // 数据页从 1 GiB 处分配，所以虚拟地址与物理地址不同
+    std::unique_ptr<Mmu> mmu;
+    if (config.vm) {
+        PageTable page_table(memory, 0x00100000, 0x40000000);
+        if (!page_table.map(0, 0x00200000, config.page_size)) {
+            return 1;
+        }
+        mmu.reset(new Mmu("Mmu", config));
+        mmu->set_root(page_table.root());
 
-            // 如果所有级别都未命中
-            if (!hit) {
-                std::cout << "Cache miss! Fetching from memory." << std::endl;
-                data = 0xDEADBEEF; // 假设从主存返回的数据
-                r_data.write(data);
-                for (uint8_t level = 0; level < levels; level++) {
-                    update_cache(level, addr, data);
-                }
-            }
-            ready.write(true);
-        } else if (write.read()) {
-            // 写操作逻辑
-            uint32_t data_to_write = w_data.read();
-
-            // 写入所有缓存级别（write-through）
-            for (uint8_t level = 0; level < levels; level++) {
-                update_cache(level, addr, data_to_write);
-            }
+        mmu->clk(clk_signal);
+        mmu->read(r_signal);
+        mmu->write(w_signal);
+        mmu->address(addr);
+        mmu->w_data(wdata);
+        mmu->req_id(req_id);
+        mmu->pc(pc);
+        mmu->r_data(rdata);
+        mmu->resp_id(resp_id);
+        mmu->ready(ready_signal);
+        mmu->full(full_signal);
 
-            std::cout << "Written data to all cache levels!" << std::endl;
-            ready.write(true);
-        }
+        mmu->cache_read(c_r_signal);
+        mmu->cache_write(c_w_signal);
+        mmu->cache_address(c_addr);
+        mmu->cache_w_data(c_wdata);
+        mmu->cache_req_id(c_req_id);
+        mmu->cache_pc(c_pc);
+        mmu->cache_r_data(c_rdata);
+        mmu->cache_resp_id(c_resp_id);
+        mmu->cache_ready(c_ready_signal);
+        mmu->cache_full(c_full_signal);
     }
-}
 
-// 查找缓存
-bool Cache::search_cache(uint32_t level, uint32_t addr, uint32_t& data) {
-    uint32_t tag = addr / line_sizes[level];
-    uint32_t index = (addr / line_sizes[level]) % caches[level].size();
-    uint32_t offset = addr % line_sizes[level];
-
-    CacheLine& line = caches[level][index];
-    if (line.valid && line.tag == tag) {
-        data = 0;
-        for (int i = 0; i < 4; i++) {
-            data = (data << 8) | line.data[offset + i];
-        }
-        return true; // Cache hit
-    }
-    return false; // Cache miss
-}
+    // 信号连接
+    bool vm = config.vm;
+    cache.clk(clk_signal);
+    cache.read(vm ? c_r_signal : r_signal);
+    cache.write(vm ? c_w_signal : w_signal);
+    cache.address(vm ? c_addr : addr);
+    cache.w_data(vm ? c_wdata : wdata);
+    cache.req_id(vm ? c_req_id : req_id);
+    cache.pc(vm ? c_pc : pc);
+    cache.r_data(vm ? c_rdata : rdata);
+    cache.resp_id(vm ? c_resp_id : resp_id);
+    cache.ready(vm ? c_ready_signal : ready_signal);
+    cache.full(vm ? c_full_signal : full_signal);
 
-// 更新缓存
-void Cache::update_cache(uint32_t level, uint32_t addr, uint32_t data) {
-    uint32_t tag = addr / line_sizes[level];
-    uint32_t index = (addr / line_sizes[level]) % caches[level].size();
-    uint32_t offset = addr % line_sizes[level];
-
-    CacheLine& line = caches[level][index];
-    line.valid = true;
-    line.tag = tag;
-    for (int i = 3; i >= 0; i--) {
-        line.data[offset + i] = data & 0xFF;
-        data >>= 8;
-    }
-}
+    cache.mem_read(mem_r_signal);
+    cache.mem_write(mem_w_signal);
+    cache.mem_exclusive(mem_exclusive);
+    cache.mem_shared(mem_shared);
+    cache.mem_address(mem_addr);
+    cache.mem_w_data(mem_wdata);
+    cache.mem_req_id(mem_req_id);
+    cache.mem_ready(mem_ready_signal);
+    cache.mem_full(mem_full_signal);
+    cache.mem_r_data(mem_rdata);
+    cache.mem_resp_id(mem_resp_id);
+    cache.mem_burst_len(mem_burst_len);
+    cache.mem_w_line(mem_wline);
+    cache.mem_r_line(mem_rline);
 
-// 主程序
-int sc_main(int argc, char** argv) {
-    sc_signal<bool> w_signal, r_signal, ready_signal;
-    sc_signal<uint32_t> wdata, addr, rdata;
-    sc_clock clk_signal("clk_signal", 10, SC_NS);
+    memory.clk(clk_signal);
+    memory.read(mem_r_signal);
+    memory.write(mem_w_signal);
+    memory.address(mem_addr);
+    memory.w_data(mem_wdata);
+    memory.req_id(mem_req_id);
+    memory.burst_len(mem_burst_len);
+    memory.w_line(mem_wline);
+    memory.r_data(mem_rdata);
+    memory.r_line(mem_rline);
+    memory.resp_id(mem_resp_id);
+    memory.ready(mem_ready_signal);
+    memory.full(mem_full_signal);
 
-    // 实例化缓存模块
-    Cache cache("Cache");
+    // 请求只保持一个周期，然后等待 ready
+    auto run_until_ready = [&]() {
+        int cycles = 1;
+        sc_start(10, SC_NS);
+        w_signal.write(false);
+        r_signal.write(false);
+        while (!ready_signal.read()) {
+            sc_start(10, SC_NS);
+            cycles++;
+        }
+        std::cout << "Latency: " << std::dec << cycles << " cycles" << std::endl;
+    };
 
-    // 信号连接
-    cache.clk(clk_signal);
-    cache.read(r_signal);
-    cache.write(w_signal);
-    cache.address(addr);
-    cache.w_data(wdata);
-    cache.r_data(rdata);
-    cache.ready(ready_signal);
-
-    // 测试用例 1: 写数据
+    auto read_at = [&](uint32_t address) {
+        addr.write(address);
+        r_signal.write(true);
+        run_until_ready();
+        std::cout << "Read data: " << std::hex << rdata.read() << std::endl;
+    };
+
+    // 测试用例 1: 写数据。默认写分配 + 写回：取回缓存行，只写 L1 并置脏位
     std::cout << "[TEST 1] Writing data 0x12345678 to address 0x00000000" << std::endl;
     wdata.write(0x12345678);
     addr.write(0x00000000);
     w_signal.write(true);
     r_signal.write(false);
-    sc_start(10, SC_NS);
+    run_until_ready();
 
     // 测试用例 2: 读数据
     std::cout << "[TEST 2] Reading data from address 0x00000000" << std::endl;
-    w_signal.write(false);
-    r_signal.write(true);
-    sc_start(10, SC_NS);
-
-    std::cout << "Read data: " << std::hex << rdata.read() << std::endl;
+    read_at(0x00000000);
 
-    // 测试用例 3: 缓存未命中
+    // 测试用例 3: 缓存未命中，从主存取回（未写过的地址读为 0）
     std::cout << "[TEST 3] Reading data from address 0x00001000 (Cache miss)" << std::endl;
-    addr.write(0x00001000);
-    sc_start(10, SC_NS);
-    std::cout << "Read data: " << std::hex << rdata.read() << std::endl;
+    read_at(0x00001000);
+
+    // 测试用例 4: 0x00000000 与 0x00001000 映射到 L1 的同一组，组相联时两者共存
+    std::cout << "[TEST 4] Reading data from address 0x00000000 again (same set as 0x00001000)" << std::endl;
+    read_at(0x00000000);
+
+    // 测试用例 5: 同一组再读三条缓存行，把 0x00000000 从 L1 和 L2 中替换出去
+    std::cout << "[TEST 5] Reading 0x00002000, 0x00003000, 0x00004000 to evict 0x00000000" << std::endl;
+    read_at(0x00002000);
+    read_at(0x00003000);
+    read_at(0x00004000);
+
+    // 测试用例 6: 再次读取 0x00000000，应为测试 1 写入的值（脏行替换时已写回）
+    std::cout << "[TEST 6] Reading data from address 0x00000000 (after eviction)" << std::endl;
+    read_at(0x00000000);
+
+    // 测试用例 7: 每周期发出一个读请求，不等前面的完成。0x00005000 与 0x00006000
+    // 的缺失并行取回，0x00005004 合并到 0x00005000 的缺失上，0x00000000 在缺失
+    // 未完成时命中 L1，最先返回
+    std::cout << "[TEST 7] Back-to-back reads to 0x00005000, 0x00006000, 0x00005004, 0x00000000 (hit under miss)"
+              << std::endl;
+    const uint32_t burst[4] = {0x00005000, 0x00006000, 0x00005004, 0x00000000};
+    int sent = 0, done = 0, cycles = 0;
+    while (done < 4) {
+        if (sent < 4 && !full_signal.read()) {
+            addr.write(burst[sent]);
+            req_id.write(sent + 1);
+            r_signal.write(true);
+            sent++;
+        } else {
+            r_signal.write(false);
+        }
+        sc_start(10, SC_NS);
+        cycles++;
+        if (ready_signal.read()) {
+            std::cout << "Response for request " << std::dec << resp_id.read() << " after " << cycles
+                      << " cycles, data: " << std::hex << rdata.read() << std::endl;
+            done++;
+        }
+    }
+    req_id.write(0);
+
+    // 测试用例 8: 由同一条指令顺序扫描 0x00008000 开始的 16 条缓存行，每 16 字节读一次，
+    // 每次等上一次完成。配置了预取器（例如 L1.prefetch=next_line、L1.prefetch=stride、
+    // L1.prefetch=stream）时，后面的缓存行在前面的访问期间取回，总周期数明显减少
+    std::cout << "[TEST 8] Sequential sweep over 0x00008000-0x000083ff, one read at a time" << std::endl;
+    pc.write(0x00400100);
+    int sweep_cycles = 0;
+    for (uint32_t offset = 0; offset < 0x400; offset += 16) {
+        addr.write(0x00008000 + offset);
+        r_signal.write(true);
+        sc_start(10, SC_NS);
+        sweep_cycles++;
+        r_signal.write(false);
+        while (!ready_signal.read()) {
+            sc_start(10, SC_NS);
+            sweep_cycles++;
+        }
+    }
+    pc.write(0);
+    std::cout << "Sweep of 64 reads took " << std::dec << sweep_cycles << " cycles" << std::endl;
+
+    // 测试用例 9: 轮流读映射到 L1 同一组的 4 条缓存行，共 3 轮。2 路的 L1 每次都冲突缺失；
+    // 挂上牺牲缓存（L1.victim=2）或提高相联度（L1.ways=4）后，第 2 轮起都在 L1 命中
+    std::cout << "[TEST 9] Reading 0x00009000, 0x0000a000, 0x0000b000, 0x0000c000 three times (conflict misses)"
+              << std::endl;
+    int conflict_cycles = 0;
+    for (int round = 0; round < 3; round++) {
+        for (uint32_t line = 0x00009000; line <= 0x0000c000; line += 0x1000) {
+            addr.write(line);
+            r_signal.write(true);
+            sc_start(10, SC_NS);
+            conflict_cycles++;
+            r_signal.write(false);
+            while (!ready_signal.read()) {
+                sc_start(10, SC_NS);
+                conflict_cycles++;
+            }
+        }
+    }
+    std::cout << "12 conflicting reads took " << std::dec << conflict_cycles << " cycles" << std::endl;
+
+    // 测试用例 10: 每周期发出一个写，连续写 0x0000d000 开始的 16 个字（像日志追加一样），
+    // 再读回其中一个字。没有存储缓冲时写都合并到这一行的缺失上，要等缓存行取回才完成；
+    // 配置了存储缓冲（例如 store_buffer=4）时写合并进同一表项立即完成，读由缓冲转发
+    std::cout << "[TEST 10] Store burst to 0x0000d000-0x0000d03f, then reading 0x0000d008" << std::endl;
+    sent = done = 0;
+    int store_cycles = 0;
+    while (done < 16) {
+        if (sent < 16 && !full_signal.read()) {
+            addr.write(0x0000d000 + sent * 4);
+            wdata.write(0xd0000000 + sent);
+            req_id.write(sent + 1);
+            w_signal.write(true);
+            sent++;
+        } else {
+            w_signal.write(false);
+        }
+        sc_start(10, SC_NS);
+        store_cycles++;
+        if (ready_signal.read()) {
+            done++;
+        }
+    }
+    req_id.write(0);
+    std::cout << "16 stores took " << std::dec << store_cycles << " cycles" << std::endl;
+    read_at(0x0000d008);
+
+    // 测试用例 11: 每周期发出一个读，先连续读同一行 0x0000d000 中的 16 个字，再轮流读相邻的两行
+    // 0x0000d000 / 0x0000d040（先读一次 0x0000d040 把它取进来）。不划分存储体时两组都是每周期
+    // 完成一个；划分存储体且一次访问占用端口多个周期时（例如 L1.banks=2 L1.bank_busy=2），
+    // 同一行的访问落在同一存储体上互相等待，相邻两行落在不同的存储体上可以交替进行。
+    // L1 不流水时（例如 L1.latency=3 L1.stages=1）两组都是每 3 个周期完成一个
+    std::cout << "[TEST 11] Back-to-back reads within 0x0000d000, then alternating 0x0000d000 / 0x0000d040"
+              << std::endl;
+    read_at(0x0000d040);
+    auto pipelined_reads = [&](uint32_t stride) {
+        int sent_reads = 0;
+        int done_reads = 0;
+        int cycles = 0;
+        while (done_reads < 16) {
+            if (sent_reads < 16 && !full_signal.read()) {
+                addr.write(0x0000d000 + (stride == 4 ? sent_reads * 4 : (sent_reads % 2) * stride + sent_reads / 2 * 4));
+                r_signal.write(true);
+                sent_reads++;
+            } else {
+                r_signal.write(false);
+            }
+            sc_start(10, SC_NS);
+            cycles++;
+            if (ready_signal.read()) {
+                done_reads++;
+            }
+        }
+        r_signal.write(false);
+        return cycles;
+    };
+    int same_line_cycles = pipelined_reads(4);
+    int two_line_cycles = pipelined_reads(0x40);
+    std::cout << "16 reads in one line took " << std::dec << same_line_cycles << " cycles, alternating two lines took "
+              << two_line_cycles << " cycles" << std::endl;
+
+    // 测试用例 12: 从 0x00100000 开始每 4 KiB 读一次，共 256 页，扫两遍。配置了虚拟内存时，
+    // 4 KiB 页（vm=true）超出两级 TLB 的覆盖范围，每次访问都要遍历页表；
+    // 2 MiB 或 1 GiB 页（page_size=2M）时整个区域只占 TLB 的一项
+    std::cout << "[TEST 12] Reading one word per 4 KiB page over 0x00100000-0x001fffff, twice" << std::endl;
+    int page_cycles = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        for (uint32_t page = 0x00100000; page < 0x00200000; page += 0x1000) {
+            addr.write(page);
+            r_signal.write(true);
+            sc_start(10, SC_NS);
+            page_cycles++;
+            r_signal.write(false);
+            while (!ready_signal.read()) {
+                sc_start(10, SC_NS);
+                page_cycles++;
+            }
+        }
+    }
+    std::cout << "512 page-strided reads took " << std::dec << page_cycles << " cycles" << std::endl;
+
+    // 测试用例 13: 先读 0x0000e000、0x0000e200、0x0000e400 开始的各 8 条缓存行，L1（2 路）中只剩后两组，
+    // 第一组还在 L2（4 路）中；再每周期发出一个读，连续读第一组的 8 条行，都在 L2 命中。
+    // L2 完全流水时每周期可以进入一个新的访问；不流水（L2.stages=1）时每 3 个周期才能进入一个
+    std::cout << "[TEST 13] Back-to-back L2 hits to 0x0000e000-0x0000e1c0" << std::endl;
+    for (uint32_t base = 0x0000e000; base <= 0x0000e400; base += 0x200) {
+        for (uint32_t line = base; line < base + 0x200; line += 0x40) {
+            addr.write(line);
+            r_signal.write(true);
+            sc_start(10, SC_NS);
+            r_signal.write(false);
+            while (!ready_signal.read()) {
+                sc_start(10, SC_NS);
+            }
+        }
+    }
+    sent = done = 0;
+    int l2_cycles = 0;
+    while (done < 8) {
+        if (sent < 8 && !full_signal.read()) {
+            addr.write(0x0000e000 + sent * 0x40);
+            r_signal.write(true);
+            sent++;
+        } else {
+            r_signal.write(false);
+        }
+        sc_start(10, SC_NS);
+        l2_cycles++;
+        if (ready_signal.read()) {
+            done++;
+        }
+    }
+    r_signal.write(false);
+    std::cout << "8 L2 hits took " << std::dec << l2_cycles << " cycles" << std::endl;
 
     // 结束仿真
+    if (mmu) {
+        mmu->print_stats(std::cout);
+    }
+    cache.print_stats(std::cout);
+    memory.print_stats(std::cout);
     std::cout << "Simulation ends" << std::endl;
 
     return 0;
@@ -0,0 +1,87 @@
+#ifndef TAG_STORE_HPP
+#define TAG_STORE_HPP
+
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+// 结构数组（SoA）形式的标签存储：每组的标签连续存放（补齐到 8 路），
+// 有效位和脏位按组各打包成一个 64 位掩码，因此每组最多 64 路。
+// 查找时用 SIMD 一次比较一组中的 8 路（AVX2）或 4 路（SSE4.1），
+// 编译目标不支持时退回标量循环
+class TagStore {
+public:
+    static const uint32_t MAX_WAYS = 64;
+
+    TagStore(uint32_t sets, uint32_t ways)
+        : ways(ways), stride((ways + 7) & ~7u), tags(sets * stride, 0), valid(sets, 0), dirty(sets, 0) {}
+
+    // 返回命中的路，未命中返回 -1
+    int find(uint32_t set, uint32_t tag) const {
+        uint64_t hits = match(&tags[set * stride], tag) & valid[set];
+        return hits ? __builtin_ctzll(hits) : -1;
+    }
+
+    // 返回组内第一个无效的路，没有时返回 -1
+    int find_invalid(uint32_t set) const {
+        uint64_t free_ways = ~valid[set] & way_mask();
+        return free_ways ? __builtin_ctzll(free_ways) : -1;
+    }
+
+    void insert(uint32_t set, uint32_t way, uint32_t tag) {
+        tags[set * stride + way] = tag;
+        valid[set] |= 1ull << way;
+        dirty[set] &= ~(1ull << way);
+    }
+
+    void invalidate(uint32_t set, uint32_t way) {
+        valid[set] &= ~(1ull << way);
+        dirty[set] &= ~(1ull << way);
+    }
+
+    void mark_dirty(uint32_t set, uint32_t way) { dirty[set] |= 1ull << way; }
+    void clear_dirty(uint32_t set, uint32_t way) { dirty[set] &= ~(1ull << way); }
+
+    bool is_valid(uint32_t set, uint32_t way) const { return (valid[set] >> way) & 1; }
+    bool is_dirty(uint32_t set, uint32_t way) const { return (dirty[set] >> way) & 1; }
+    uint32_t tag_at(uint32_t set, uint32_t way) const { return tags[set * stride + way]; }
+
+private:
+    uint64_t way_mask() const { return ways == 64 ? ~0ull : (1ull << ways) - 1; }
+
+    // 比较一组的全部标签，返回相等的路的位掩码（补齐的路由有效位屏蔽）
+    uint64_t match(const uint32_t* set_tags, uint32_t tag) const {
+        uint64_t mask = 0;
+#if defined(__AVX2__)
+        __m256i key = _mm256_set1_epi32(tag);
+        for (uint32_t way = 0; way < stride; way += 8) {
+            __m256i row = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(set_tags + way));
+            __m256i eq = _mm256_cmpeq_epi32(row, key);
+            mask |= (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(eq)) << way;
+        }
+#elif defined(__SSE4_1__)
+        __m128i key = _mm_set1_epi32(tag);
+        for (uint32_t way = 0; way < stride; way += 4) {
+            __m128i row = _mm_loadu_si128(reinterpret_cast<const __m128i*>(set_tags + way));
+            __m128i eq = _mm_cmpeq_epi32(row, key);
+            mask |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(eq)) << way;
+        }
+#else
+        for (uint32_t way = 0; way < ways; way++) {
+            mask |= (uint64_t)(set_tags[way] == tag) << way;
+        }
+#endif
+        return mask;
+    }
+
+    uint32_t ways;
+    uint32_t stride;              // 每组占用的标签槽数（8 的倍数）
+    std::vector<uint32_t> tags;   // sets * stride
+    std::vector<uint64_t> valid;  // 每组一个有效位掩码
+    std::vector<uint64_t> dirty;  // 每组一个脏位掩码（写回策略）
+};
+
+#endif
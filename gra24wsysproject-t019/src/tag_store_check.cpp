@@ -0,0 +1,143 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "tag_store.hpp"
+
+// 用逐路比较的标量参考模型随机校验 TagStore：插入、失效、置脏 / 清脏之后，
+// find、find_invalid、is_valid、is_dirty 和 tag_at 的结果都必须与参考模型一致。
+// TagStore 的比较核心由编译选项决定，三种都应运行一遍：
+//   g++ -std=c++17 -O2 tag_store_check.cpp -o tag_store_check                # 标量
+//   g++ -std=c++17 -O2 -msse4.1 tag_store_check.cpp -o tag_store_check      # SSE4.1
+//   g++ -std=c++17 -O2 -mavx2 tag_store_check.cpp -o tag_store_check        # AVX2
+// 用法：tag_store_check [每种路数的操作次数]，默认 200000。不依赖 SystemC
+
+#if defined(__AVX2__)
+static const char* const KERNEL = "AVX2";
+#elif defined(__SSE4_1__)
+static const char* const KERNEL = "SSE4.1";
+#else
+static const char* const KERNEL = "scalar";
+#endif
+
+// 参考模型：每路一项，查找时按路号从小到大逐一比较
+struct RefWay {
+    bool valid = false;
+    bool dirty = false;
+    uint32_t tag = 0;
+};
+
+// xorshift32，种子固定，结果可重现
+static uint32_t next_random(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// 对 sets 组、ways 路的 TagStore 做 operations 次随机操作，返回不一致的次数（只打印前几个）
+static uint64_t check_ways(uint32_t sets, uint32_t ways, uint64_t operations, uint32_t seed) {
+    TagStore store(sets, ways);
+    std::vector<RefWay> ref(sets * ways);
+    uint32_t state = seed;
+    uint64_t errors = 0;
+    auto report = [&](const char* what, uint32_t set, uint64_t got, uint64_t expected) {
+        if (++errors <= 5) {
+            std::cerr << KERNEL << ", " << ways << " ways, set " << set << ": " << what << " returned " << (int64_t)got
+                      << ", expected " << (int64_t)expected << std::endl;
+        }
+    };
+
+    for (uint64_t op = 0; op < operations; op++) {
+        uint32_t set = next_random(state) % sets;
+        uint32_t way = next_random(state) % ways;
+        // 标签取自很小的范围，使命中、失效路中残留的旧标签和补齐槽中的 0 都经常被比较到
+        uint32_t tag = next_random(state) % (ways + 4);
+        RefWay* row = &ref[set * ways];
+
+        switch (next_random(state) % 8) {
+        case 0:
+        case 1: {
+            // 填入：与 CacheLevel 一样先找无效的路，标签不与组内有效的路重复
+            bool present = false;
+            for (uint32_t w = 0; w < ways; w++) {
+                present |= row[w].valid && row[w].tag == tag;
+            }
+            if (present) {
+                break;
+            }
+            int free_way = store.find_invalid(set);
+            uint32_t target = free_way >= 0 ? free_way : way;
+            store.insert(set, target, tag);
+            row[target].valid = true;
+            row[target].dirty = false;
+            row[target].tag = tag;
+            break;
+        }
+        case 2:
+            store.invalidate(set, way);
+            row[way].valid = false;
+            row[way].dirty = false;
+            break;
+        case 3:
+            if (row[way].valid) {
+                store.mark_dirty(set, way);
+                row[way].dirty = true;
+            }
+            break;
+        case 4:
+            store.clear_dirty(set, way);
+            row[way].dirty = false;
+            break;
+        default:
+            break;
+        }
+
+        int expected = -1;
+        int expected_free = -1;
+        for (uint32_t w = 0; w < ways; w++) {
+            if (expected < 0 && row[w].valid && row[w].tag == tag) {
+                expected = w;
+            }
+            if (expected_free < 0 && !row[w].valid) {
+                expected_free = w;
+            }
+        }
+        int found = store.find(set, tag);
+        if (found != expected) {
+            report("find", set, found, expected);
+        }
+        int free_way = store.find_invalid(set);
+        if (free_way != expected_free) {
+            report("find_invalid", set, free_way, expected_free);
+        }
+        if (store.is_valid(set, way) != row[way].valid) {
+            report("is_valid", set, store.is_valid(set, way), row[way].valid);
+        }
+        if (store.is_dirty(set, way) != row[way].dirty) {
+            report("is_dirty", set, store.is_dirty(set, way), row[way].dirty);
+        }
+        if (row[way].valid && store.tag_at(set, way) != row[way].tag) {
+            report("tag_at", set, store.tag_at(set, way), row[way].tag);
+        }
+    }
+    return errors;
+}
+
+int main(int argc, char** argv) {
+    uint64_t operations = argc > 1 ? std::strtoull(argv[1], nullptr, 0) : 200000;
+    if (operations == 0) {
+        std::cerr << "usage: tag_store_check [operations per associativity]" << std::endl;
+        return 1;
+    }
+
+    // 覆盖 1 到 MAX_WAYS 的每一种路数，包括不是 8 的倍数（有补齐槽）的情况
+    uint64_t errors = 0;
+    for (uint32_t ways = 1; ways <= TagStore::MAX_WAYS; ways++) {
+        errors += check_ways(16, ways, operations, ways * 2654435761u | 1);
+    }
+    std::cout << KERNEL << " tag compare: " << errors << " mismatches over " << TagStore::MAX_WAYS
+              << " associativities" << std::endl;
+    return errors ? 1 : 0;
+}
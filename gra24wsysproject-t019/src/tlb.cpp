@@ -0,0 +1,90 @@
+#include "tlb.hpp"
+
+const char* page_size_name(uint32_t shift) {
+    switch (shift) {
+    case 12:
+        return "4K";
+    case 21:
+        return "2M";
+    default:
+        return "1G";
+    }
+}
+
+Tlb::Tlb(uint32_t entries, uint32_t ways)
+    : ways(ways), sets(entries ? entries / ways : 0), table(entries, Entry{false, 0, 0, 0, 0}) {}
+
+int Tlb::find(uint32_t vaddr, uint32_t shift) const {
+    if (table.empty()) {
+        return -1;
+    }
+    uint32_t vpn = vaddr >> shift;
+    uint32_t base = set_of(vpn) * ways;
+    for (uint32_t way = 0; way < ways; way++) {
+        const Entry& entry = table[base + way];
+        if (entry.valid && entry.shift == shift && entry.vpn == vpn) {
+            return base + way;
+        }
+    }
+    return -1;
+}
+
+bool Tlb::lookup(uint32_t vaddr, uint32_t& paddr, uint32_t& shift) {
+    for (uint32_t kind = 0; kind < PAGE_SIZE_KINDS; kind++) {
+        uint32_t base = 0;
+        if (lookup_page(vaddr, PAGE_SHIFTS[kind], base)) {
+            shift = PAGE_SHIFTS[kind];
+            paddr = base | (vaddr & ((1u << shift) - 1));
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Tlb::lookup_page(uint32_t vaddr, uint32_t shift, uint32_t& base) {
+    int index = find(vaddr, shift);
+    if (index < 0) {
+        return false;
+    }
+    table[index].last_use = ++stamp;
+    base = table[index].base;
+    return true;
+}
+
+void Tlb::insert(uint32_t vaddr, uint32_t shift, uint32_t base) {
+    if (table.empty()) {
+        return;
+    }
+    int index = find(vaddr, shift);
+    if (index < 0) {
+        uint32_t first = set_of(vaddr >> shift) * ways;
+        index = first;
+        for (uint32_t way = 0; way < ways; way++) {
+            const Entry& entry = table[first + way];
+            if (!entry.valid) {
+                index = first + way;
+                break;
+            }
+            if (entry.last_use < table[index].last_use) {
+                index = first + way;
+            }
+        }
+    }
+    table[index] = Entry{true, shift, vaddr >> shift, base, ++stamp};
+}
+
+void Tlb::flush() {
+    for (Entry& entry : table) {
+        entry.valid = false;
+    }
+}
+
+uint64_t Tlb::reach() const {
+    uint64_t bytes = 0;
+    for (const Entry& entry : table) {
+        if (entry.valid) {
+            bytes += 1ull << entry.shift;
+        }
+    }
+    return bytes;
+}
@@ -0,0 +1,61 @@
+#ifndef TLB_HPP
+#define TLB_HPP
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// 页大小：4 KiB、2 MiB、1 GiB，分别对应页表第 1、2、3 级的叶子项，值为页内偏移的位数
+const uint32_t PAGE_SHIFTS[] = {12, 21, 30};
+const uint32_t PAGE_SIZE_KINDS = 3;
+
+const char* page_size_name(uint32_t shift);
+
+// 组相联的地址翻译缓存，按 LRU 替换。同一个表中可以混放各种页大小：每项记录自己的页大小，
+// 查找时按每种页大小分别取组号（虚拟页号的低位）探查。
+// 也用作页表遍历缓存：键为虚拟地址在某一级的前缀，值为下一级页表的物理地址
+class Tlb {
+public:
+    static const uint32_t MAX_WAYS = 64;
+
+    // entries 为 0 时不启用。entries / ways 须为 2 的幂
+    Tlb(uint32_t entries, uint32_t ways);
+
+    bool enabled() const { return !table.empty(); }
+
+    // 按各种页大小查找 vaddr，命中时写出物理地址和页大小（页内偏移位数）并返回 true
+    bool lookup(uint32_t vaddr, uint32_t& paddr, uint32_t& shift);
+
+    // 只按一种页大小查找，命中时写出 vaddr 所在页的物理基址
+    bool lookup_page(uint32_t vaddr, uint32_t shift, uint32_t& base);
+
+    // 放入 vaddr 所在的、大小为 1 << shift 的页，物理基址为 base
+    void insert(uint32_t vaddr, uint32_t shift, uint32_t base);
+
+    // 清空（切换地址空间）
+    void flush();
+
+    uint32_t entries() const { return table.size(); }
+
+    // 当前有效的项覆盖的字节数（TLB reach）
+    uint64_t reach() const;
+
+private:
+    struct Entry {
+        bool valid;
+        uint32_t shift;     // 页大小
+        uint32_t vpn;       // vaddr >> shift
+        uint32_t base;      // 物理基址
+        uint64_t last_use;  // LRU
+    };
+
+    int find(uint32_t vaddr, uint32_t shift) const;
+    uint32_t set_of(uint32_t vpn) const { return vpn & (sets - 1); }
+
+    uint32_t ways;
+    uint32_t sets;
+    std::vector<Entry> table;  // sets * ways
+    uint64_t stamp = 0;
+};
+
+#endif
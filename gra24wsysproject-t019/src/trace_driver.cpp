@@ -0,0 +1,63 @@
+#include "trace_driver.hpp"
+
+TraceDriver::TraceDriver(sc_module_name name, TraceReader& reader, uint32_t window) : sc_module(name),
+    reader(reader), window(window)
+{
+    SC_THREAD(process_driver);
+    sensitive << clk.pos();
+}
+
+// 每个时钟上升沿：收取至多一个完成的访问，再发出至多一条记录。请求只保持一个周期
+void TraceDriver::process_driver() {
+    while (true) {
+        wait();
+        cycle++;
+        read.write(false);
+        write.write(false);
+
+        if (ready.read()) {
+            outstanding--;
+            completed++;
+        }
+
+        if (!has_pending) {
+            has_pending = reader.next(pending);
+        }
+        if (!has_pending) {
+            if (outstanding == 0) {
+                sc_stop();
+            }
+            continue;
+        }
+        if (full.read()) {
+            full_stalls++;
+            continue;
+        }
+        if (outstanding >= window) {
+            window_stalls++;
+            continue;
+        }
+
+        address.write(pending.addr);
+        w_data.write(pending.data);
+        req_id.write(next_id);
+        pc.write(0);
+        read.write(!pending.write);
+        write.write(pending.write);
+        next_id = next_id == UINT32_MAX ? 1 : next_id + 1;
+        outstanding++;
+        if (pending.write) {
+            writes++;
+        } else {
+            reads++;
+        }
+        has_pending = false;
+    }
+}
+
+void TraceDriver::print_stats(std::ostream& os) const {
+    os << std::dec << "Trace: " << reads + writes << " accesses (" << reads << " reads, " << writes << " writes), "
+       << cycle << " cycles, " << (cycle ? (double)completed / cycle : 0.0) << " accesses per cycle" << std::endl;
+    os << "  window " << window << ", stalls: full " << full_stalls << ", window " << window_stalls
+       << ", bad records " << reader.errors() << std::endl;
+}
@@ -0,0 +1,53 @@
+#ifndef TRACE_DRIVER_HPP
+#define TRACE_DRIVER_HPP
+
+#include <systemc.h>
+#include <iostream>
+
+#include "trace_reader.hpp"
+
+// trace 驱动的请求方：接在 Cache（或 Mmu）的请求方端口上，每个时钟上升沿从 TraceReader 取出
+// 下一条记录发出，不需要主程序逐个周期推进仿真。同时未完成的访问最多 window 个
+// （window 为 1 时等上一个访问完成再发下一个），full 为高时暂停。
+// 记录读完、所有访问都完成后调用 sc_stop 结束仿真
+class TraceDriver : public sc_module {
+public:
+    sc_in<bool> clk;          // 时钟信号
+    sc_out<bool> read;        // 读操作信号
+    sc_out<bool> write;       // 写操作信号
+    sc_out<uint32_t> address; // 地址信号
+    sc_out<uint32_t> w_data;  // 写入数据信号
+    sc_out<uint32_t> req_id;  // 请求编号
+    sc_out<uint32_t> pc;      // trace 中没有 PC，接 0
+    sc_in<uint32_t> r_data;   // 读出数据信号
+    sc_in<uint32_t> resp_id;  // 完成的请求编号
+    sc_in<bool> ready;        // 操作完成信号
+    sc_in<bool> full;         // 缓存暂停接收请求
+
+    SC_HAS_PROCESS(TraceDriver);
+
+    TraceDriver(sc_module_name name, TraceReader& reader, uint32_t window);
+
+    // 打印发出的读写数、经过的周期、每周期完成的访问数和停顿原因
+    void print_stats(std::ostream& os) const;
+
+private:
+    TraceReader& reader;
+    uint32_t window;
+    TraceRecord pending;        // 已从 trace 取出、还没发出的记录
+    bool has_pending = false;
+    uint32_t outstanding = 0;   // 已发出、还没完成的访问
+    uint32_t next_id = 1;
+    uint64_t cycle = 0;
+
+    // 统计
+    uint64_t reads = 0;
+    uint64_t writes = 0;
+    uint64_t completed = 0;
+    uint64_t full_stalls = 0;    // 有记录要发，但 full 为高
+    uint64_t window_stalls = 0;  // 有记录要发，但未完成的访问已有 window 个
+
+    void process_driver();
+};
+
+#endif
@@ -0,0 +1,264 @@
+#include "trace_reader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const char TraceReader::MAGIC[4] = {'S', 'T', 'R', 'C'};
+
+static const uint64_t MAX_REPORTED_ERRORS = 10;  // 之后的格式错误只计数，不再逐行打印
+
+static uint32_t load_le32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void store_le32(uint8_t* p, uint32_t value) {
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+}
+
+static const char* skip_blanks(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+    return p;
+}
+
+// 解析十进制或 0x 开头的十六进制数，返回数字之后的位置；没有数字或超出 32 位时返回 nullptr
+static const char* parse_number(const char* p, const char* end, uint32_t& value) {
+    uint64_t number = 0;
+    const char* digits = p;
+    if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+        p += 2;
+        digits = p;
+        for (; p < end; p++) {
+            char c = *p | 0x20;  // 转成小写
+            uint32_t digit;
+            if (*p >= '0' && *p <= '9') {
+                digit = *p - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                digit = c - 'a' + 10;
+            } else {
+                break;
+            }
+            number = number * 16 + digit;
+            if (number > UINT32_MAX) {
+                return nullptr;
+            }
+        }
+    } else {
+        for (; p < end && *p >= '0' && *p <= '9'; p++) {
+            number = number * 10 + (*p - '0');
+            if (number > UINT32_MAX) {
+                return nullptr;
+            }
+        }
+    }
+    if (p == digits) {
+        return nullptr;
+    }
+    value = number;
+    return p;
+}
+
+// 解析一行 R/W, 地址[, 数据]，[p, end) 已去掉行首空白和行尾换行
+static bool parse_line(const char* p, const char* end, TraceRecord& record) {
+    char op = *p++;
+    if (op == 'R' || op == 'r') {
+        record.write = false;
+    } else if (op == 'W' || op == 'w') {
+        record.write = true;
+    } else {
+        return false;
+    }
+    p = skip_blanks(p, end);
+    if (p == end || *p != ',') {
+        return false;
+    }
+    p = parse_number(skip_blanks(p + 1, end), end, record.addr);
+    if (!p || (record.addr & 3)) {
+        return false;  // 访问按字进行，地址必须字对齐，否则会越过缓存行末尾
+    }
+    p = skip_blanks(p, end);
+    record.data = 0;
+    if (p < end && *p == ',') {
+        p = skip_blanks(p + 1, end);
+        if (p == end && !record.write) {
+            return true;  // 读的数据列为空
+        }
+        p = parse_number(p, end, record.data);
+        if (!p) {
+            return false;
+        }
+        p = skip_blanks(p, end);
+    } else if (record.write) {
+        return false;
+    }
+    if (!record.write) {
+        record.data = 0;
+    }
+    return p == end;
+}
+
+TraceReader::~TraceReader() {
+    if (base) {
+        munmap(const_cast<char*>(base), length);
+    }
+}
+
+bool TraceReader::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Cannot open trace: " << path << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        std::cerr << "Cannot stat trace: " << path << std::endl;
+        close(fd);
+        return false;
+    }
+    length = st.st_size;
+    if (length == 0) {
+        close(fd);
+        return true;  // 空 trace：没有记录
+    }
+
+    void* image = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED) {
+        std::cerr << "Cannot map trace: " << path << std::endl;
+        length = 0;
+        return false;
+    }
+    madvise(image, length, MADV_SEQUENTIAL);
+    base = static_cast<const char*>(image);
+    cursor = released = base;
+    end = base + length;
+
+    if (length >= 8 && std::memcmp(base, MAGIC, sizeof(MAGIC)) == 0) {
+        uint32_t version = load_le32(reinterpret_cast<const uint8_t*>(base) + 4);
+        if (version != VERSION) {
+            std::cerr << "Unsupported binary trace version " << version << ": " << path << std::endl;
+            return false;
+        }
+        binary = true;
+        cursor += 8;
+    }
+    return true;
+}
+
+// 释放已经解析过的整页：只读的私有映射丢弃后不会再访问
+void TraceReader::release() {
+    static const uintptr_t page_mask = ~(uintptr_t)(sysconf(_SC_PAGESIZE) - 1);
+    const char* upto = reinterpret_cast<const char*>(reinterpret_cast<uintptr_t>(cursor) & page_mask);
+    if (upto > released) {
+        madvise(const_cast<char*>(released), upto - released, MADV_DONTNEED);
+        released = upto;
+    }
+}
+
+bool TraceReader::next_csv(TraceRecord& record) {
+    while (cursor < end) {
+        if ((size_t)(cursor - released) >= RELEASE_BYTES) {
+            release();
+        }
+        const char* p = cursor;
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!eol) {
+            eol = end;
+        }
+        cursor = eol < end ? eol + 1 : end;
+        line++;
+
+        const char* stop = eol > p && eol[-1] == '\r' ? eol - 1 : eol;
+        p = skip_blanks(p, stop);
+        if (p == stop || *p == '#') {
+            continue;
+        }
+        if (parse_line(p, stop, record)) {
+            record_count++;
+            return true;
+        }
+        if (line == 1 && std::find_if(p, stop, [](char c) { return c >= '0' && c <= '9'; }) == stop) {
+            continue;  // 表头：第一行且不含数字
+        }
+        if (++error_count <= MAX_REPORTED_ERRORS) {
+            std::cerr << "Bad trace record at line " << std::dec << line << ": "
+                      << std::string(p, stop - p) << std::endl;
+        }
+    }
+    return false;
+}
+
+bool TraceReader::next_binary(TraceRecord& record) {
+    while (true) {
+        if ((size_t)(cursor - released) >= RELEASE_BYTES) {
+            release();
+        }
+        if (cursor >= end) {
+            return false;
+        }
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(cursor);
+        size_t bytes = p[0] == 1 ? 9 : 5;
+        if (p[0] > 1 || (size_t)(end - cursor) < bytes) {
+            std::cerr << "Corrupt binary trace at offset " << std::dec << cursor - base << std::endl;
+            error_count++;
+            cursor = end;
+            return false;
+        }
+        record.write = p[0] == 1;
+        record.addr = load_le32(p + 1);
+        record.data = record.write ? load_le32(p + 5) : 0;
+        cursor += bytes;
+        if (record.addr & 3) {
+            // 与 CSV 相同：地址不是字对齐的记录跳过
+            if (++error_count <= MAX_REPORTED_ERRORS) {
+                std::cerr << "Unaligned address in binary trace at offset " << std::dec
+                          << cursor - bytes - base << ": 0x" << std::hex << record.addr << std::dec << std::endl;
+            }
+            continue;
+        }
+        record_count++;
+        return true;
+    }
+}
+
+bool TraceWriter::open(const std::string& path) {
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Cannot create trace: " << path << std::endl;
+        return false;
+    }
+    std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+    uint8_t header[8];
+    std::memcpy(header, TraceReader::MAGIC, sizeof(TraceReader::MAGIC));
+    store_le32(header + 4, TraceReader::VERSION);
+    std::fwrite(header, 1, sizeof(header), file);
+    return true;
+}
+
+void TraceWriter::write(const TraceRecord& record) {
+    uint8_t bytes[9];
+    bytes[0] = record.write ? 1 : 0;
+    store_le32(bytes + 1, record.addr);
+    store_le32(bytes + 5, record.data);
+    std::fwrite(bytes, 1, record.write ? 9 : 5, file);
+}
+
+bool TraceWriter::close() {
+    if (!file) {
+        return true;
+    }
+    bool ok = !std::ferror(file);
+    ok = std::fclose(file) == 0 && ok;
+    file = nullptr;
+    return ok;
+}
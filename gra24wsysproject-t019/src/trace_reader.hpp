@@ -0,0 +1,82 @@
+#ifndef TRACE_READER_HPP
+#define TRACE_READER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// trace 中的一次访存
+struct TraceRecord {
+    bool write;
+    uint32_t addr;
+    uint32_t data;  // 读时为 0
+};
+
+// 流式读取访存 trace。文件只读映射（mmap）后顺序解析，不整个读入内存：
+// 按顺序访问提示内核预读，已经解析过的部分每 RELEASE_BYTES 字节释放一次，
+// 常驻内存不随文件大小增长。支持两种格式，按文件开头的魔数区分：
+//   CSV：每行 R/W, 地址, 数据（数字为十进制或 0x 开头的十六进制，读可以省略数据），
+//        # 开头的行和空行忽略，第一行不含数字时当作表头跳过；格式错误的行打印行号后跳过
+//   二进制：8 字节文件头（魔数 "STRC" 和小端 32 位版本号 1），之后每条记录 1 字节操作
+//        （0 读，1 写）、4 字节小端地址，写再跟 4 字节小端数据
+// 访问都是 32 位字，两种格式中地址不是 4 字节对齐的记录都算格式错误，跳过并计入 errors()
+class TraceReader {
+public:
+    static const char MAGIC[4];
+    static const uint32_t VERSION = 1;
+    static const size_t RELEASE_BYTES = 64u << 20;
+
+    TraceReader() {}
+    ~TraceReader();
+
+    // 打开并映射 trace 文件，失败时打印原因并返回 false
+    bool open(const std::string& path);
+
+    // 读出下一条记录，读完（或二进制 trace 在记录中间截断）时返回 false
+    bool next(TraceRecord& record) { return binary ? next_binary(record) : next_csv(record); }
+
+    bool is_binary() const { return binary; }
+    uint64_t records() const { return record_count; }
+    uint64_t errors() const { return error_count; }
+    size_t size() const { return length; }
+
+private:
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    bool next_csv(TraceRecord& record);
+    bool next_binary(TraceRecord& record);
+    void release();
+
+    const char* base = nullptr;
+    size_t length = 0;
+    const char* cursor = nullptr;
+    const char* end = nullptr;
+    const char* released = nullptr;  // 之前的部分已经释放
+    bool binary = false;
+    uint64_t line = 0;               // CSV 的行号
+    uint64_t record_count = 0;
+    uint64_t error_count = 0;
+};
+
+// 把记录写成二进制 trace（TraceReader 的二进制格式），经 stdio 缓冲
+class TraceWriter {
+public:
+    TraceWriter() {}
+    ~TraceWriter() { close(); }
+
+    // 创建文件并写入文件头，失败时打印原因并返回 false
+    bool open(const std::string& path);
+    void write(const TraceRecord& record);
+    // 写完并关闭，写入出错时返回 false
+    bool close();
+
+private:
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    FILE* file = nullptr;
+};
+
+#endif
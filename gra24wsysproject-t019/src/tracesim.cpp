@@ -0,0 +1,209 @@
+#include <systemc.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "cache.hpp"
+#include "memory.hpp"
+#include "mmu.hpp"
+#include "page_table.hpp"
+#include "trace_driver.hpp"
+#include "trace_reader.hpp"
+
+// 只解析 trace、按二进制格式写到 out，打印解析速度，不仿真
+static int convert_trace(TraceReader& reader, const std::string& out) {
+    TraceWriter writer;
+    if (!writer.open(out)) {
+        return 1;
+    }
+    auto begin = std::chrono::steady_clock::now();
+    TraceRecord record;
+    while (reader.next(record)) {
+        writer.write(record);
+    }
+    if (!writer.close()) {
+        std::cerr << "Error writing trace: " << out << std::endl;
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Converted " << reader.records() << " records (" << reader.size() << " bytes, " << reader.errors()
+              << " bad records) in " << seconds << " s, "
+              << (seconds > 0 ? reader.size() / seconds / (1 << 20) : 0.0) << " MiB/s" << std::endl;
+    return 0;
+}
+
+// 主程序：按 trace 中的访存驱动缓存层次结构。
+// 用法：tracesim <trace> [配置文件 | key=value]...，trace 为 CSV 或二进制格式（见 trace_reader.hpp）。
+// 除缓存配置外还接受 window=N（同时未完成的访问数，默认 8）和 convert=<文件>（转成二进制 trace 后退出）
+int sc_main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: tracesim <trace> [config file | key=value]..." << std::endl;
+        return 1;
+    }
+    TraceReader reader;
+    if (!reader.open(argv[1])) {
+        return 1;
+    }
+
+    CacheConfig config;
+    uint32_t window = 8;
+    std::string convert;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        bool ok = true;
+        if (arg.compare(0, 7, "window=") == 0) {
+            window = std::strtoul(arg.c_str() + 7, nullptr, 0);
+            ok = window > 0;
+            if (!ok) {
+                std::cerr << "Window must be at least 1: " << arg << std::endl;
+            }
+        } else if (arg.compare(0, 8, "convert=") == 0) {
+            convert = arg.substr(8);
+        } else {
+            ok = arg.find('=') != std::string::npos ? config.parse_option(arg) : config.load(arg);
+        }
+        if (!ok) {
+            return 1;
+        }
+    }
+    if (!convert.empty()) {
+        return convert_trace(reader, convert);
+    }
+    if (!config.validate()) {
+        return 1;
+    }
+    if (config.cores > 1) {
+        std::cerr << "tracesim replays a single trace on one core" << std::endl;
+        return 1;
+    }
+    config.print(std::cout);
+    std::cout << "Trace: " << argv[1] << " (" << (reader.is_binary() ? "binary" : "CSV") << ", " << reader.size()
+              << " bytes), window " << window << std::endl;
+
+    sc_signal<bool> w_signal, r_signal, ready_signal, full_signal;
+    sc_signal<uint32_t> wdata, addr, rdata, req_id, resp_id, pc;
+    sc_clock clk_signal("clk_signal", 10, SC_NS);
+
+    sc_signal<bool> mem_w_signal, mem_r_signal, mem_ready_signal, mem_full_signal;
+    sc_signal<bool> mem_exclusive, mem_shared;
+    sc_signal<uint32_t> mem_wdata, mem_addr, mem_rdata, mem_req_id, mem_resp_id, mem_burst_len;
+    sc_signal<MemLine> mem_wline, mem_rline;
+
+    // 配置了虚拟内存时 trace 中是虚拟地址，经 Mmu 翻译后再进入缓存
+    sc_signal<bool> c_w_signal, c_r_signal, c_ready_signal, c_full_signal;
+    sc_signal<uint32_t> c_wdata, c_addr, c_rdata, c_req_id, c_resp_id, c_pc;
+
+    TraceDriver driver("Driver", reader, window);
+    Cache cache("Cache", config);
+    Memory memory("Memory");
+
+    driver.clk(clk_signal);
+    driver.read(r_signal);
+    driver.write(w_signal);
+    driver.address(addr);
+    driver.w_data(wdata);
+    driver.req_id(req_id);
+    driver.pc(pc);
+    driver.r_data(rdata);
+    driver.resp_id(resp_id);
+    driver.ready(ready_signal);
+    driver.full(full_signal);
+
+    // 虚拟内存：映射虚拟地址空间的前 1 GiB，页表放在物理地址 1 MiB 处，数据页从 1 GiB 处分配。
+    // trace 中更高的地址缺页
+    std::unique_ptr<Mmu> mmu;
+    if (config.vm) {
+        PageTable page_table(memory, 0x00100000, 0x40000000);
+        if (!page_table.map(0, 0x40000000, config.page_size)) {
+            return 1;
+        }
+        mmu.reset(new Mmu("Mmu", config));
+        mmu->set_root(page_table.root());
+
+        mmu->clk(clk_signal);
+        mmu->read(r_signal);
+        mmu->write(w_signal);
+        mmu->address(addr);
+        mmu->w_data(wdata);
+        mmu->req_id(req_id);
+        mmu->pc(pc);
+        mmu->r_data(rdata);
+        mmu->resp_id(resp_id);
+        mmu->ready(ready_signal);
+        mmu->full(full_signal);
+
+        mmu->cache_read(c_r_signal);
+        mmu->cache_write(c_w_signal);
+        mmu->cache_address(c_addr);
+        mmu->cache_w_data(c_wdata);
+        mmu->cache_req_id(c_req_id);
+        mmu->cache_pc(c_pc);
+        mmu->cache_r_data(c_rdata);
+        mmu->cache_resp_id(c_resp_id);
+        mmu->cache_ready(c_ready_signal);
+        mmu->cache_full(c_full_signal);
+    }
+
+    bool vm = config.vm;
+    cache.clk(clk_signal);
+    cache.read(vm ? c_r_signal : r_signal);
+    cache.write(vm ? c_w_signal : w_signal);
+    cache.address(vm ? c_addr : addr);
+    cache.w_data(vm ? c_wdata : wdata);
+    cache.req_id(vm ? c_req_id : req_id);
+    cache.pc(vm ? c_pc : pc);
+    cache.r_data(vm ? c_rdata : rdata);
+    cache.resp_id(vm ? c_resp_id : resp_id);
+    cache.ready(vm ? c_ready_signal : ready_signal);
+    cache.full(vm ? c_full_signal : full_signal);
+
+    cache.mem_read(mem_r_signal);
+    cache.mem_write(mem_w_signal);
+    cache.mem_exclusive(mem_exclusive);
+    cache.mem_shared(mem_shared);
+    cache.mem_address(mem_addr);
+    cache.mem_w_data(mem_wdata);
+    cache.mem_req_id(mem_req_id);
+    cache.mem_ready(mem_ready_signal);
+    cache.mem_full(mem_full_signal);
+    cache.mem_r_data(mem_rdata);
+    cache.mem_resp_id(mem_resp_id);
+    cache.mem_burst_len(mem_burst_len);
+    cache.mem_w_line(mem_wline);
+    cache.mem_r_line(mem_rline);
+
+    memory.clk(clk_signal);
+    memory.read(mem_r_signal);
+    memory.write(mem_w_signal);
+    memory.address(mem_addr);
+    memory.w_data(mem_wdata);
+    memory.req_id(mem_req_id);
+    memory.burst_len(mem_burst_len);
+    memory.w_line(mem_wline);
+    memory.r_data(mem_rdata);
+    memory.r_line(mem_rline);
+    memory.resp_id(mem_resp_id);
+    memory.ready(mem_ready_signal);
+    memory.full(mem_full_signal);
+
+    // 各模块每次访问打印的过程信息对长 trace 没有意义，仿真期间关闭标准输出，只保留最后的统计
+    auto begin = std::chrono::steady_clock::now();
+    std::cout.setstate(std::ios::failbit);
+    sc_start();
+    std::cout.clear();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    driver.print_stats(std::cout);
+    std::cout << "  simulated in " << seconds << " s, "
+              << (seconds > 0 ? reader.records() / seconds : 0.0) << " accesses per second" << std::endl;
+    if (mmu) {
+        mmu->print_stats(std::cout);
+    }
+    cache.print_stats(std::cout);
+    memory.print_stats(std::cout);
+    std::cout << "Simulation ends" << std::endl;
+
+    return 0;
+}
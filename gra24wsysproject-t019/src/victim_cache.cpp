@@ -0,0 +1,104 @@
+#include "victim_cache.hpp"
+
+#include <cstring>
+
+VictimCache::VictimCache(uint32_t entries, uint32_t line_size)
+    : line_size(line_size), lines(entries, Line{false, false, 0, 0}), data(entries * line_size, 0) {}
+
+int VictimCache::find(uint32_t addr) const {
+    uint32_t line_addr = addr & ~(line_size - 1);
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (lines[i].valid && lines[i].addr == line_addr) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool VictimCache::insert(uint32_t addr, const uint8_t* bytes, bool dirty,
+                         uint32_t& out_addr, bool& out_dirty, uint8_t* out) {
+    // 优先用空项，否则挤出最久未用的一项
+    int slot = 0;
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (!lines[i].valid) {
+            slot = i;
+            break;
+        }
+        if (lines[i].last_use < lines[slot].last_use) {
+            slot = i;
+        }
+    }
+
+    Line& line = lines[slot];
+    bool pushed_out = line.valid;
+    if (pushed_out) {
+        out_addr = line.addr;
+        out_dirty = line.dirty;
+        std::memcpy(out, bytes_of(slot), line_size);
+        evicted++;
+    }
+
+    line.valid = true;
+    line.dirty = dirty;
+    line.addr = addr & ~(line_size - 1);
+    line.last_use = ++stamp;
+    std::memcpy(bytes_of(slot), bytes, line_size);
+    inserted++;
+    return pushed_out;
+}
+
+bool VictimCache::take(uint32_t addr, uint8_t* bytes, bool& dirty) {
+    int index = find(addr);
+    if (index < 0) {
+        return false;
+    }
+    dirty = lines[index].dirty;
+    std::memcpy(bytes, bytes_of(index), line_size);
+    lines[index].valid = false;
+    return true;
+}
+
+const uint8_t* VictimCache::peek(uint32_t addr, bool& dirty) const {
+    int index = find(addr);
+    if (index < 0) {
+        return nullptr;
+    }
+    dirty = lines[index].dirty;
+    return bytes_of(index);
+}
+
+void VictimCache::clean(uint32_t addr) {
+    int index = find(addr);
+    if (index >= 0) {
+        lines[index].dirty = false;
+    }
+}
+
+bool VictimCache::write_word(uint32_t addr, uint32_t word, bool dirty) {
+    int index = find(addr);
+    if (index < 0) {
+        return false;
+    }
+    uint8_t* line = bytes_of(index) + (addr & (line_size - 1));
+    for (int i = 0; i < 4; i++) {
+        line[i] = word & 0xFF;
+        word >>= 8;
+    }
+    lines[index].dirty |= dirty;
+    return true;
+}
+
+bool VictimCache::write_line(uint32_t addr, const uint8_t* bytes, uint32_t size, bool dirty) {
+    int index = find(addr);
+    if (index < 0) {
+        return false;
+    }
+    std::memcpy(bytes_of(index) + (addr & (line_size - 1)), bytes, size);
+    lines[index].dirty |= dirty;
+    return true;
+}
+
+void VictimCache::print_stats(std::ostream& os, uint32_t level) const {
+    os << std::dec << "L" << level + 1 << " victim cache (" << lines.size() << " entries): absorbed "
+       << absorbed_count << " misses, inserted " << inserted << ", evicted " << evicted << std::endl;
+}
@@ -0,0 +1,66 @@
+#ifndef VICTIM_CACHE_HPP
+#define VICTIM_CACHE_HPP
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// 牺牲缓存（victim cache）：挂在某一级下面的小型全相联缓冲，保存该级替换出的缓存行。
+// 该级未命中时与它并行查找，命中时与该级交换，延迟与该级命中相同。
+// 逻辑上属于这一级：行从牺牲缓存挤出时才算离开这一级（写回、包含模式的反向失效等）。
+// 项数很少（最多 64），按 LRU 替换，查找为线性扫描
+class VictimCache {
+public:
+    static const uint32_t MAX_ENTRIES = 64;
+
+    VictimCache(uint32_t entries, uint32_t line_size);
+
+    bool enabled() const { return !lines.empty(); }
+
+    // 放入本级替换出的缓存行（line_size 字节）。已满时挤出最久未用的一条，
+    // 把它的地址、脏位和数据复制到 out_addr / out_dirty / out，返回 true
+    bool insert(uint32_t addr, const uint8_t* bytes, bool dirty,
+                uint32_t& out_addr, bool& out_dirty, uint8_t* out);
+
+    // 取出包含 addr 的缓存行（移出牺牲缓存），不在时返回 false
+    bool take(uint32_t addr, uint8_t* bytes, bool& dirty);
+
+    // 返回包含 addr 的缓存行数据和脏位，不在时返回 nullptr
+    const uint8_t* peek(uint32_t addr, bool& dirty) const;
+
+    // 清除包含 addr 的缓存行的脏位
+    void clean(uint32_t addr);
+
+    // 在牺牲缓存中更新一个字或写入上一级写回的数据，不在时返回 false
+    bool write_word(uint32_t addr, uint32_t word, bool dirty);
+    bool write_line(uint32_t addr, const uint8_t* bytes, uint32_t size, bool dirty);
+
+    // 本级的一次缺失由牺牲缓存满足
+    void absorbed() { absorbed_count++; }
+
+    void print_stats(std::ostream& os, uint32_t level) const;
+
+private:
+    struct Line {
+        bool valid;
+        bool dirty;
+        uint32_t addr;      // 缓存行地址
+        uint64_t last_use;  // LRU
+    };
+
+    int find(uint32_t addr) const;
+    uint8_t* bytes_of(int index) { return &data[index * line_size]; }
+    const uint8_t* bytes_of(int index) const { return &data[index * line_size]; }
+
+    uint32_t line_size;
+    std::vector<Line> lines;
+    std::vector<uint8_t> data;  // entries * line_size
+    uint64_t stamp = 0;
+
+    // 统计
+    uint64_t inserted = 0;
+    uint64_t evicted = 0;
+    uint64_t absorbed_count = 0;
+};
+
+#endif